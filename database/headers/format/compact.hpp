@@ -0,0 +1,225 @@
+/******************************************************************************/
+/*                                                                            */
+/*   This file is part of SWI-LS.                                             */
+/*                                                                            */
+/*   SWI-LS is free software: you can redistribute it and/or modify           */
+/*   it under the terms of the GNU General Public License as published by     */
+/*   the Free Software Foundation, either version 2 of the License, or        */
+/*   any later version.                                                       */
+/*                                                                            */
+/*   SWI-LS is distributed in the hope that it will be useful,                */
+/*   but WITHOUT ANY WARRANTY; without even the implied warranty of           */
+/*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            */
+/*   GNU General Public License for more details.                             */
+/*                                                                            */
+/*   You should have received a copy of the GNU General Public License        */
+/*   along with SWI-LS.  If not, see <http://www.gnu.org/licenses/>.          */
+/*                                                                            */
+/******************************************************************************/
+
+/* ************************************************************************** */
+/* Compact databases: distances only, bit-packed in rank order                */
+/* ************************************************************************** */
+
+#ifndef __FORMAT_COMPACT__
+#define __FORMAT_COMPACT__
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iostream>
+#include <cinttypes>
+
+#include <linear/ranking.hpp>
+
+// A compact database keeps the distance of every permutation of size n,
+// indexed by rank (see linear/ranking.hpp), so the permutations themselves
+// are implicit. Distances are packed with the same number of bits each (at
+// least 4, enough for the largest distance), from the least significant bit
+// of each byte. The file starts with a small header and ends with one byte of
+// padding, so any distance can be read with two consecutive bytes.
+
+// First word of the compact databases ("SWILSCP1").
+#define COMPACT_MAGIC 0x315043534c495753ULL
+
+// Number of bytes kept by the buffers of the readers and writers.
+#define COMPACT_BUFFER 65536
+
+// Header of the compact databases
+struct CompactHeader {
+  __uint64_t magic;
+  __uint8_t n;
+  __uint8_t sign;
+  __uint8_t bits;
+  __uint8_t maxDistance;
+  __uint32_t reserved;
+  __uint64_t count;
+};
+
+// Returns the number of bits used to keep distances up to the given one.
+static inline int compactBits(const int maxDistance) {
+  int bits = 4;
+  while ((1 << bits) <= maxDistance) ++bits;
+  return bits;
+}
+
+// Returns the distance of the given rank, from the packed distances.
+static inline int compactDistance(const __uint8_t *data, const int bits, const __uint64_t rank) {
+  __uint64_t bit = rank * bits;
+  __uint32_t word = data[bit >> 3] | (data[(bit >> 3) + 1] << 8);
+  return (word >> (bit & 7)) & ((1u << bits) - 1);
+}
+
+// Returns true if the given file is a compact database.
+static inline bool isCompactFile(const std::string name) {
+  std::ifstream file(name, std::ios::in | std::ios::binary);
+  __uint64_t magic = 0;
+  file.read(reinterpret_cast<char *>(&magic), sizeof(magic));
+  return file.good() && magic == COMPACT_MAGIC;
+}
+
+// Class CompactWriter: It writes the distances of a compact database in rank
+// order.
+class CompactWriter {
+
+private:
+
+  std::ofstream file;
+  std::string name;
+  int bits;
+  __uint32_t accumulator;
+  int accumulated;
+  std::vector<__uint8_t> buffer;
+
+  void flushBuffer() {
+    file.write(reinterpret_cast<const char *>(buffer.data()), buffer.size());
+    buffer.clear();
+  }
+
+public:
+
+  // Constructor
+  CompactWriter(const std::string N, const int n, const bool sign, const int maxDistance) {
+    name = N;
+    bits = compactBits(maxDistance);
+    accumulator = 0;
+    accumulated = 0;
+    buffer.reserve(COMPACT_BUFFER);
+    file.open(name, std::ios::out | std::ios::trunc | std::ios::binary);
+    if (!file.is_open()) {
+      std::cerr << std::endl << "ERROR!!! Could not open file " << name << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    CompactHeader header;
+    header.magic = COMPACT_MAGIC;
+    header.n = n;
+    header.sign = sign;
+    header.bits = bits;
+    header.maxDistance = maxDistance;
+    header.reserved = 0;
+    header.count = permutationCount(n, sign);
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  }
+
+  // Destructor
+  ~CompactWriter() {
+    close();
+  }
+
+  // Writes the distance of the next rank
+  void write(const int distance) {
+    accumulator |= distance << accumulated;
+    accumulated += bits;
+    while (accumulated >= 8) {
+      buffer.push_back(accumulator & 255);
+      accumulator >>= 8;
+      accumulated -= 8;
+    }
+    if (buffer.size() >= COMPACT_BUFFER) flushBuffer();
+  }
+
+  // Writes the last byte and the padding and closes the file
+  void close() {
+    if (!file.is_open()) return;
+    if (accumulated > 0) buffer.push_back(accumulator & 255);
+    buffer.push_back(0);
+    flushBuffer();
+    file.close();
+    if (!file.good()) {
+      std::cerr << std::endl << "ERROR!!! Could not write file " << name << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+    }
+  }
+
+};
+
+// Class CompactReader: Sequential reader of the distances of a compact
+// database, in rank order.
+class CompactReader {
+
+private:
+
+  std::ifstream file;
+  CompactHeader compactHeader;
+  __uint64_t nextRank;
+  __uint32_t accumulator;
+  int accumulated;
+  std::vector<__uint8_t> buffer;
+  size_t index;
+  size_t size;
+
+  void fill() {
+    file.read(reinterpret_cast<char *>(buffer.data()), buffer.size());
+    size = file.gcount();
+    index = 0;
+  }
+
+public:
+
+  // Constructor
+  CompactReader(const std::string name) {
+    file.open(name, std::ios::in | std::ios::binary);
+    file.read(reinterpret_cast<char *>(&compactHeader), sizeof(compactHeader));
+    if (!file.good() || compactHeader.magic != COMPACT_MAGIC) {
+      std::cerr << std::endl << "ERROR!!! Invalid compact database " << name << "." << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    buffer = std::vector<__uint8_t>(COMPACT_BUFFER);
+    rewind();
+  }
+
+  // Returns the header of the database
+  const CompactHeader &header() const { return compactHeader; }
+
+  // Moves back to the first rank
+  void rewind() {
+    file.clear();
+    file.seekg(sizeof(CompactHeader), std::ios::beg);
+    nextRank = 0;
+    accumulator = 0;
+    accumulated = 0;
+    fill();
+  }
+
+  // Reads the distance of the next rank. Returns false after the last rank.
+  bool next(__uint64_t &rank, int &distance) {
+    if (nextRank == compactHeader.count) return false;
+    while (accumulated < compactHeader.bits) {
+      if (index == size) fill();
+      if (size == 0) {
+	std::cerr << std::endl << "ERROR!!! Truncated compact database." << std::endl << std::endl;
+	exit(EXIT_FAILURE);
+      }
+      accumulator |= buffer[index++] << accumulated;
+      accumulated += 8;
+    }
+    distance = accumulator & ((1u << compactHeader.bits) - 1);
+    accumulator >>= compactHeader.bits;
+    accumulated -= compactHeader.bits;
+    rank = nextRank++;
+    return true;
+  }
+
+};
+
+#endif // __FORMAT_COMPACT__
@@ -0,0 +1,166 @@
+/******************************************************************************/
+/*                                                                            */
+/*   This file is part of SWI-LS.                                             */
+/*                                                                            */
+/*   SWI-LS is free software: you can redistribute it and/or modify           */
+/*   it under the terms of the GNU General Public License as published by     */
+/*   the Free Software Foundation, either version 2 of the License, or        */
+/*   any later version.                                                       */
+/*                                                                            */
+/*   SWI-LS is distributed in the hope that it will be useful,                */
+/*   but WITHOUT ANY WARRANTY; without even the implied warranty of           */
+/*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            */
+/*   GNU General Public License for more details.                             */
+/*                                                                            */
+/*   You should have received a copy of the GNU General Public License        */
+/*   along with SWI-LS.  If not, see <http://www.gnu.org/licenses/>.          */
+/*                                                                            */
+/******************************************************************************/
+
+/* ************************************************************************** */
+/* Header of the binary databases                                             */
+/* ************************************************************************** */
+
+#ifndef __FORMAT_DATABASE__
+#define __FORMAT_DATABASE__
+
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <cinttypes>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <linear/ranking.hpp>
+
+// A binary database is a sequence of records (permutation in integer format
+// and distance, two words of 16, 32 or 64 bits) in non-decreasing order of
+// distance. It starts with a header which describes the permutations and the
+// records, and keeps the offset of the first record of each distance, so the
+// layer of distance d is the interval [offsets[d], offsets[d + 1]) of the
+// file and offsets[layers] is the size of the file. Databases generated before
+// the header existed start with the record of the identity (all bits zero),
+// so they are told apart by the first word.
+//
+// A database written to a stream (the standard output) can not rewrite its
+// header at the end, so the header has the count DATABASE_STREAM and no
+// layers: the readers of streams take the records up to the end of the
+// stream, and readDatabaseHeader rebuilds the offsets of a file saved from a
+// stream.
+
+// First word of the binary databases ("SWILSDB1") and version of the header.
+#define DATABASE_MAGIC 0x314244534c495753ULL
+#define DATABASE_VERSION 1
+
+// Maximum number of distances (layers) of a database.
+#define DATABASE_LAYERS 256
+
+// Number of records of a database written to a stream (unknown when the
+// header is written).
+#define DATABASE_STREAM 0xFFFFFFFFFFFFFFFFULL
+
+// Name of the standard input or output, given instead of a file name.
+#define DATABASE_STDIO "-"
+
+// Header of the binary databases
+struct DatabaseHeader {
+  __uint64_t magic;
+  __uint32_t version;
+  __uint8_t n;
+  __uint8_t sign;
+  __uint8_t wordBits;
+  __uint8_t symmetry;
+  __uint32_t layers;
+  __uint32_t reserved;
+  __uint64_t count;
+  __uint64_t offsets[DATABASE_LAYERS + 1];
+};
+
+// Returns the number of bits of each word of a record: the smallest word size
+// (16, 32 or 64 bits) which keeps a permutation of size n in integer format.
+static inline int databaseWordBits(const int n, const bool sign) {
+  if (n * packedBits(sign) <= 16) return 16;
+  if (n * packedBits(sign) <= 32) return 32;
+  return 64;
+}
+
+// Returns true if the fields of the given header are valid (the count and
+// the offsets are not verified)
+static inline bool validDatabaseHeader(const DatabaseHeader &header) {
+  return header.version == DATABASE_VERSION && header.layers <= DATABASE_LAYERS &&
+    header.wordBits == databaseWordBits(header.n, header.sign);
+}
+
+// Fills the count and the offsets of the header of a database saved from a
+// stream, reading the distances of its records.
+static inline bool rebuildDatabaseHeader(std::ifstream &infile, const __uint64_t size, DatabaseHeader &header) {
+  int recordBytes = header.wordBits / 4;
+  if ((size - sizeof(header)) % recordBytes != 0) return false;
+  header.count = (size - sizeof(header)) / recordBytes;
+  header.layers = 0;
+  std::vector<char> buffer(recordBytes * 4096);
+  __uint64_t offset = sizeof(header);
+  infile.seekg(offset, std::ios::beg);
+  while (offset < size) {
+    infile.read(buffer.data(), std::min((__uint64_t)buffer.size(), size - offset));
+    if (infile.gcount() == 0) return false;
+    for (std::streamsize r = 0; r < infile.gcount(); r += recordBytes, offset += recordBytes) {
+      __uint64_t distance = 0;
+      memcpy(&distance, buffer.data() + r + recordBytes / 2, recordBytes / 2);
+      if (distance + 1 < header.layers || distance >= DATABASE_LAYERS) return false;
+      for (; header.layers <= distance; ++header.layers)
+	header.offsets[header.layers] = offset;
+    }
+  }
+  header.offsets[header.layers] = size;
+  return true;
+}
+
+// Reads the header of the given database. Returns false if the database has
+// no header (older databases). Stops the program if the header is not valid
+// or if the size of the file is not the one given by the header.
+static inline bool readDatabaseHeader(const std::string file, DatabaseHeader &header) {
+  std::ifstream infile(file, std::ios::in | std::ios::binary);
+  infile.read(reinterpret_cast<char *>(&header), sizeof(header));
+  if (!infile.good() || header.magic != DATABASE_MAGIC) return false;
+  struct stat status;
+  bool valid = validDatabaseHeader(header) && stat(file.c_str(), &status) == 0;
+  if (valid && header.count == DATABASE_STREAM)
+    valid = rebuildDatabaseHeader(infile, status.st_size, header);
+  if (!valid || (__uint64_t)status.st_size != header.offsets[header.layers] ||
+      header.offsets[header.layers] != sizeof(header) + header.count * header.wordBits / 4) {
+    std::cerr << std::endl << "ERROR!!! Invalid or truncated database " << file << "." << std::endl << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  return true;
+}
+
+// Reads the header of a database from the given file descriptor (for
+// instance, the standard input). Returns false if the database has no
+// header: the bytes read are then the first records, kept in the given
+// vector. Stops the program if the header is not valid.
+static inline bool readDatabaseHeader(const int descriptor, DatabaseHeader &header, std::vector<char> &records) {
+  char* bytes = reinterpret_cast<char *>(&header);
+  size_t size = 0;
+  while (size < sizeof(header)) {
+    ssize_t got = read(descriptor, bytes + size, sizeof(header) - size);
+    if (got <= 0) break;
+    size += got;
+  }
+  if (size < sizeof(header.magic) || header.magic != DATABASE_MAGIC) {
+    records.assign(bytes, bytes + size);
+    return false;
+  }
+  if (size != sizeof(header) || !validDatabaseHeader(header)) {
+    std::cerr << std::endl << "ERROR!!! Invalid or truncated database header." << std::endl << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  records.clear();
+  return true;
+}
+
+#endif // __FORMAT_DATABASE__
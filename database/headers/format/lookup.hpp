@@ -0,0 +1,90 @@
+/******************************************************************************/
+/*                                                                            */
+/*   This file is part of SWI-LS.                                             */
+/*                                                                            */
+/*   SWI-LS is free software: you can redistribute it and/or modify           */
+/*   it under the terms of the GNU General Public License as published by     */
+/*   the Free Software Foundation, either version 2 of the License, or        */
+/*   any later version.                                                       */
+/*                                                                            */
+/*   SWI-LS is distributed in the hope that it will be useful,                */
+/*   but WITHOUT ANY WARRANTY; without even the implied warranty of           */
+/*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            */
+/*   GNU General Public License for more details.                             */
+/*                                                                            */
+/*   You should have received a copy of the GNU General Public License        */
+/*   along with SWI-LS.  If not, see <http://www.gnu.org/licenses/>.          */
+/*                                                                            */
+/******************************************************************************/
+
+/* ************************************************************************** */
+/* Lookup of optimal distances in a memory-mapped compact database            */
+/* ************************************************************************** */
+
+#ifndef __FORMAT_LOOKUP__
+#define __FORMAT_LOOKUP__
+
+#include <string>
+#include <cstdlib>
+#include <iostream>
+#include <cinttypes>
+
+#include <linear/ranking.hpp>
+#include <format/compact.hpp>
+#include <format/mapped.hpp>
+
+// Class DistanceLookup: It maps a compact database (see format/compact.hpp)
+// into memory and returns the distance of any permutation with one rank
+// computation and one load.
+class DistanceLookup {
+
+private:
+
+  // Mapped database
+  MappedFile file;
+
+  // Header and packed distances
+  const CompactHeader* compactHeader;
+  const __uint8_t* data;
+
+public:
+
+  // Constructor
+  DistanceLookup(const std::string name) : file(name) {
+    compactHeader = reinterpret_cast<const CompactHeader*>(file.data());
+    data = file.data() + sizeof(CompactHeader);
+    if (file.size() < sizeof(CompactHeader) || compactHeader->magic != COMPACT_MAGIC ||
+	file.size() < sizeof(CompactHeader) + (compactHeader->count * compactHeader->bits + 7) / 8 + 1) {
+      std::cerr << std::endl << "ERROR!!! Invalid compact database " << name << "." << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  // Permutation size and type of the database
+  int size() const { return compactHeader->n; }
+  bool isSigned() const { return compactHeader->sign; }
+
+  // Returns the distance of the given permutation (integer format)
+  int distance(const __uint64_t intPi) const {
+    return compactDistance(data, compactHeader->bits,
+			   permutationRank(compactHeader->n, compactHeader->sign, intPi));
+  }
+
+  // Returns the distance of the given permutation, which must have the same
+  // size and type as the database. P is any class with the method
+  // element_at(i), which returns the (signed) element of the position i in
+  // the interval [1, n], such as the class Permutation of the heuristics.
+  template <class P>
+  int distance(const P &pi) const {
+    int bits = packedBits(compactHeader->sign);
+    __uint64_t intPi = 0;
+    for (int i = 1; i <= compactHeader->n; ++i) {
+      int e = pi.element_at(i);
+      intPi = (intPi << bits) | (abs(e) - 1) | (e < 0 ? 16 : 0);
+    }
+    return distance(intPi);
+  }
+
+};
+
+#endif // __FORMAT_LOOKUP__
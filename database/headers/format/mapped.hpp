@@ -0,0 +1,84 @@
+/******************************************************************************/
+/*                                                                            */
+/*   This file is part of SWI-LS.                                             */
+/*                                                                            */
+/*   SWI-LS is free software: you can redistribute it and/or modify           */
+/*   it under the terms of the GNU General Public License as published by     */
+/*   the Free Software Foundation, either version 2 of the License, or        */
+/*   any later version.                                                       */
+/*                                                                            */
+/*   SWI-LS is distributed in the hope that it will be useful,                */
+/*   but WITHOUT ANY WARRANTY; without even the implied warranty of           */
+/*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            */
+/*   GNU General Public License for more details.                             */
+/*                                                                            */
+/*   You should have received a copy of the GNU General Public License        */
+/*   along with SWI-LS.  If not, see <http://www.gnu.org/licenses/>.          */
+/*                                                                            */
+/******************************************************************************/
+
+/* ************************************************************************** */
+/* Read-only files mapped into memory                                         */
+/* ************************************************************************** */
+
+#ifndef __FORMAT_MAPPED__
+#define __FORMAT_MAPPED__
+
+#include <string>
+#include <cstdlib>
+#include <iostream>
+#include <cinttypes>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Class MappedFile: It maps a whole file into memory, read-only and shared,
+// so processes which read the same file share its pages in the page cache.
+// Random accesses are expected (no read-ahead).
+class MappedFile {
+
+private:
+
+  // Mapped file and its size
+  void* mapping;
+  size_t length;
+
+  // Not copyable (the mapping is released by the destructor)
+  MappedFile(const MappedFile&);
+  MappedFile& operator=(const MappedFile&);
+
+public:
+
+  // Constructor
+  MappedFile(const std::string file) {
+    int descriptor = open(file.c_str(), O_RDONLY);
+    struct stat status;
+    if (descriptor < 0 || fstat(descriptor, &status) != 0) {
+      std::cerr << std::endl << "ERROR!!! Could not open file " << file << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    length = status.st_size;
+    mapping = MAP_FAILED;
+    if (length > 0)
+      mapping = mmap(NULL, length, PROT_READ, MAP_SHARED, descriptor, 0);
+    close(descriptor);
+    if (mapping == MAP_FAILED) {
+      std::cerr << std::endl << "ERROR!!! Could not map file " << file << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    madvise(mapping, length, MADV_RANDOM);
+  }
+
+  // Destructor
+  ~MappedFile() {
+    munmap(mapping, length);
+  }
+
+  // Content of the file and its size
+  const __uint8_t* data() const { return static_cast<const __uint8_t*>(mapping); }
+  size_t size() const { return length; }
+
+};
+
+#endif // __FORMAT_MAPPED__
@@ -0,0 +1,100 @@
+/******************************************************************************/
+/*                                                                            */
+/*   This file is part of SWI-LS.                                             */
+/*                                                                            */
+/*   SWI-LS is free software: you can redistribute it and/or modify           */
+/*   it under the terms of the GNU General Public License as published by     */
+/*   the Free Software Foundation, either version 2 of the License, or        */
+/*   any later version.                                                       */
+/*                                                                            */
+/*   SWI-LS is distributed in the hope that it will be useful,                */
+/*   but WITHOUT ANY WARRANTY; without even the implied warranty of           */
+/*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            */
+/*   GNU General Public License for more details.                             */
+/*                                                                            */
+/*   You should have received a copy of the GNU General Public License        */
+/*   along with SWI-LS.  If not, see <http://www.gnu.org/licenses/>.          */
+/*                                                                            */
+/******************************************************************************/
+
+/* ************************************************************************** */
+/* Policy tables: one optimal inversion per permutation, in rank order        */
+/* ************************************************************************** */
+
+#ifndef __FORMAT_POLICY__
+#define __FORMAT_POLICY__
+
+#include <string>
+#include <cstdlib>
+#include <iostream>
+#include <cinttypes>
+
+#include <linear/ranking.hpp>
+#include <format/mapped.hpp>
+
+// A policy table keeps, for each permutation of size n (indexed by rank), the
+// index of an inversion which starts an optimal sorting sequence, that is,
+// the first inversion of the list given by getPossibleInversions (see
+// problem/problem.hpp) which leads to a permutation whose distance plus the
+// weight of the inversion is the distance of the permutation. The identity
+// has no inversion. Following the table from any permutation sorts it
+// optimally. The file is a small header followed by one byte per rank.
+
+// First word of the policy tables ("SWILSPO1").
+#define POLICY_MAGIC 0x314f50534c495753ULL
+
+// Index kept for the identity permutation.
+#define NO_INVERSION 255
+
+// Header of the policy tables
+struct PolicyHeader {
+  __uint64_t magic;
+  __uint8_t n;
+  __uint8_t sign;
+  __uint16_t inversions;
+  __uint32_t reserved;
+  __uint64_t count;
+};
+
+// Class PolicyTable: It maps a policy table into memory and returns the
+// optimal inversion of any permutation with one rank computation and one load.
+class PolicyTable {
+
+private:
+
+  // Mapped table
+  MappedFile file;
+
+  // Header and inversion indexes
+  const PolicyHeader* policyHeader;
+  const __uint8_t* data;
+
+public:
+
+  // Constructor
+  PolicyTable(const std::string name) : file(name) {
+    policyHeader = reinterpret_cast<const PolicyHeader*>(file.data());
+    data = file.data() + sizeof(PolicyHeader);
+    if (file.size() < sizeof(PolicyHeader) || policyHeader->magic != POLICY_MAGIC ||
+	file.size() < sizeof(PolicyHeader) + policyHeader->count) {
+      std::cerr << std::endl << "ERROR!!! Invalid policy table " << name << "." << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  // Permutation size and type of the table
+  int size() const { return policyHeader->n; }
+  bool isSigned() const { return policyHeader->sign; }
+
+  // Number of inversions of the list used by the table
+  int inversions() const { return policyHeader->inversions; }
+
+  // Returns the index of the optimal inversion of the given permutation
+  // (integer format) or NO_INVERSION for the identity.
+  int inversion(const __uint64_t intPi) const {
+    return data[permutationRank(policyHeader->n, policyHeader->sign, intPi)];
+  }
+
+};
+
+#endif // __FORMAT_POLICY__
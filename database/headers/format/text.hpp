@@ -0,0 +1,196 @@
+/******************************************************************************/
+/*                                                                            */
+/*   This file is part of SWI-LS.                                             */
+/*                                                                            */
+/*   SWI-LS is free software: you can redistribute it and/or modify           */
+/*   it under the terms of the GNU General Public License as published by     */
+/*   the Free Software Foundation, either version 2 of the License, or        */
+/*   any later version.                                                       */
+/*                                                                            */
+/*   SWI-LS is distributed in the hope that it will be useful,                */
+/*   but WITHOUT ANY WARRANTY; without even the implied warranty of           */
+/*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            */
+/*   GNU General Public License for more details.                             */
+/*                                                                            */
+/*   You should have received a copy of the GNU General Public License        */
+/*   along with SWI-LS.  If not, see <http://www.gnu.org/licenses/>.          */
+/*                                                                            */
+/******************************************************************************/
+
+/* ************************************************************************** */
+/* Buffered text records of the databases                                     */
+/* ************************************************************************** */
+
+#ifndef __FORMAT_TEXT__
+#define __FORMAT_TEXT__
+
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <cstring>
+#include <ostream>
+#include <cinttypes>
+#include <condition_variable>
+
+#include <linear/keys.hpp>
+
+// A text record is a permutation, with its elements separated by commas, a
+// space and the distance, in one line ("1,-3,2 4"). The records are
+// formatted into buffers of characters, with a table of the pairs of
+// decimal digits, and written to the streams one buffer at a time (instead
+// of one line at a time, with the integers formatted by the streams).
+
+// Number of characters kept by a buffer before it is written.
+#define TEXT_BUFFER (1 << 20)
+
+// Maximum number of characters of a record (up to 32 elements).
+#define TEXT_RECORD 160
+
+// Table of the pairs of decimal digits of the integers 0 to 99
+struct DigitTable {
+  char pairs[200];
+  DigitTable() {
+    for (int i = 0; i < 100; ++i) {
+      pairs[2 * i] = '0' + i / 10;
+      pairs[2 * i + 1] = '0' + i % 10;
+    }
+  }
+};
+
+// Writes the given integer at the given position and returns the position
+// after its last digit.
+static inline char* formatInteger(char *out, __uint64_t value) {
+  static const DigitTable table;
+  char digits[20];
+  int k = 20;
+  while (value >= 100) {
+    k -= 2;
+    memcpy(digits + k, table.pairs + 2 * (value % 100), 2);
+    value /= 100;
+  }
+  if (value >= 10) {
+    k -= 2;
+    memcpy(digits + k, table.pairs + 2 * value, 2);
+  } else {
+    digits[--k] = '0' + value;
+  }
+  memcpy(out, digits + k, 20 - k);
+  return out + 20 - k;
+}
+
+// Writes the record of the given permutation (see linear/keys.hpp) and
+// distance at the given position and returns the position after it.
+template <typename Key>
+static inline char* formatRecord(char *out, const int n, const bool sign, const Key key, const __uint64_t distance) {
+  for (int i = 0; i < n; ++i) {
+    int e = keyElement(n, sign, key, i);
+    if (i > 0) *out++ = ',';
+    if (e < 0) {
+      *out++ = '-';
+      e = -e;
+    }
+    out = formatInteger(out, e);
+  }
+  *out++ = ' ';
+  out = formatInteger(out, distance);
+  *out++ = '\n';
+  return out;
+}
+
+// Class TextBuffer: Buffer of text records. It grows as needed: writers
+// which stream the records write it whenever it is full, and the threads of
+// ChunkWriter keep the records of a whole chunk.
+class TextBuffer {
+
+private:
+
+  std::vector<char> text;
+  size_t used;
+
+public:
+
+  // Constructor
+  TextBuffer() {
+    text = std::vector<char>(TEXT_BUFFER + TEXT_RECORD);
+    used = 0;
+  }
+
+  // Appends the record of the given permutation and distance
+  template <typename Key>
+  void record(const int n, const bool sign, const Key key, const __uint64_t distance) {
+    if (used + TEXT_RECORD > text.size()) text.resize(2 * text.size());
+    used = formatRecord(text.data() + used, n, sign, key, distance) - text.data();
+  }
+
+  // Number of characters in the buffer
+  size_t size() const { return used; }
+
+  // Returns true if the buffer should be written
+  bool full() const { return used >= TEXT_BUFFER; }
+
+  // Writes the content of the buffer in the given stream and clears it
+  void write(std::ostream &stream) {
+    stream.write(text.data(), used);
+    used = 0;
+  }
+
+};
+
+// Class ChunkWriter: It formats numbered chunks of records with many threads
+// and writes them in order. The job (see run) appends the records of a given
+// chunk to a TextBuffer; each thread formats one chunk at a time and waits
+// for the previous chunks to be written before writing its own, so at most
+// one chunk per thread is kept in memory.
+template <typename Job>
+class ChunkWriter {
+
+private:
+
+  // Job, number of chunks and output stream
+  const Job &job;
+  __uint64_t chunks;
+  std::ostream &stream;
+
+  // Next chunk to be formatted and next chunk to be written
+  std::atomic<__uint64_t> nextChunk;
+  __uint64_t nextWrite;
+  std::mutex mutex;
+  std::condition_variable written;
+
+  // Formats and writes chunks
+  void work() {
+    TextBuffer buffer;
+    for (__uint64_t chunk = nextChunk++; chunk < chunks; chunk = nextChunk++) {
+      job(chunk, buffer);
+      std::unique_lock<std::mutex> lock(mutex);
+      while (nextWrite != chunk) written.wait(lock);
+      buffer.write(stream);
+      ++nextWrite;
+      written.notify_all();
+    }
+  }
+
+public:
+
+  // Constructor (the job must have the method
+  // void operator()(const __uint64_t chunk, TextBuffer &buffer) const)
+  ChunkWriter(const Job &J, const __uint64_t C, std::ostream &S) : job(J), stream(S) {
+    chunks = C;
+    nextChunk = 0;
+    nextWrite = 0;
+  }
+
+  // Writes all chunks with the given number of threads
+  void run(const int threads) {
+    std::vector<std::thread> workers;
+    for (int t = 1; t < threads; ++t)
+      workers.push_back(std::thread(&ChunkWriter::work, this));
+    work();
+    for (size_t t = 0; t < workers.size(); ++t)
+      workers[t].join();
+  }
+
+};
+
+#endif // __FORMAT_TEXT__
@@ -0,0 +1,140 @@
+/******************************************************************************/
+/*                                                                            */
+/*   This file is part of SWI-LS.                                             */
+/*                                                                            */
+/*   SWI-LS is free software: you can redistribute it and/or modify           */
+/*   it under the terms of the GNU General Public License as published by     */
+/*   the Free Software Foundation, either version 2 of the License, or        */
+/*   any later version.                                                       */
+/*                                                                            */
+/*   SWI-LS is distributed in the hope that it will be useful,                */
+/*   but WITHOUT ANY WARRANTY; without even the implied warranty of           */
+/*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            */
+/*   GNU General Public License for more details.                             */
+/*                                                                            */
+/*   You should have received a copy of the GNU General Public License        */
+/*   along with SWI-LS.  If not, see <http://www.gnu.org/licenses/>.          */
+/*                                                                            */
+/******************************************************************************/
+
+/* ************************************************************************** */
+/* Packed permutations (integer format) parameterised on the key type         */
+/* ************************************************************************** */
+
+#ifndef __LINEAR_KEYS__
+#define __LINEAR_KEYS__
+
+#include <cstdlib>
+#include <cstddef>
+#include <cinttypes>
+
+#include <linear/swar.hpp>
+
+// A permutation in integer format keeps one field per position, the first
+// position in the most significant field. Each field keeps the absolute
+// value of the element minus one and, for signed permutations, a sign bit
+// above it. The width of the fields depends on the key type: 64-bit keys
+// use 5 bits (signed) or 4 bits (unsigned), as the rest of the linear
+// headers, and 128-bit keys use 6 or 5 bits, so they keep signed
+// permutations of up to 21 elements and unsigned permutations of up to 25
+// elements.
+
+// Type of the 128-bit keys.
+typedef __uint128_t wide_key;
+
+// Number of bits of each field of the given key type.
+template <typename Key> struct KeyTraits;
+template <> struct KeyTraits<__uint64_t> { static const int signedBits = 5; static const int unsignedBits = 4; };
+template <> struct KeyTraits<wide_key>   { static const int signedBits = 6; static const int unsignedBits = 5; };
+
+// Returns the number of bits of each field.
+template <typename Key>
+static inline int keyBits(const bool sign) {
+  return sign ? KeyTraits<Key>::signedBits : KeyTraits<Key>::unsignedBits;
+}
+
+// Returns the maximum permutation size kept by a key.
+template <typename Key>
+static inline int keyMaxSize(const bool sign) {
+  return (sizeof(Key) * 8) / keyBits<Key>(sign);
+}
+
+// Returns the element (in the interval [-n, n]) at the position i (in the
+// interval [0, n - 1]) of the given permutation.
+template <typename Key>
+static inline int keyElement(const int n, const bool sign, const Key key, const int i) {
+  int bits = keyBits<Key>(sign);
+  int field = (int)(key >> ((n - 1 - i) * bits)) & ((1 << bits) - 1);
+  if (!sign) return field + 1;
+  int value = (field & ((1 << (bits - 1)) - 1)) + 1;
+  return (field >> (bits - 1)) ? -value : value;
+}
+
+// Returns the given permutation (elements at the positions 0 to n - 1 of any
+// indexable container) as a key.
+template <typename Key, typename V>
+static inline Key packKey(const int n, const bool sign, const V &pi) {
+  int bits = keyBits<Key>(sign);
+  Key key = 0;
+  for (int i = 0; i < n; ++i) {
+    int e = pi[i];
+    Key field = abs(e) - 1;
+    if (e < 0) field |= (Key)1 << (bits - 1);
+    key = (key << bits) | field;
+  }
+  return key;
+}
+
+// Fills the positions 0 to n - 1 of the given container with the elements
+// of the given permutation.
+template <typename Key, typename V>
+static inline void unpackKey(const int n, const bool sign, const Key key, V &pi) {
+  for (int i = 0; i < n; ++i)
+    pi[i] = keyElement(n, sign, key, i);
+}
+
+// Applies the inversion of the positions i to j (0 <= i <= j < n) to the
+// given permutation and returns the resulting permutation. The fields are
+// swapped one pair at a time; 64-bit keys use the kernel of linear/swar.hpp.
+template <typename Key>
+static inline Key keyInversion(const int n, const bool sign, const Key key, int i, int j) {
+  int bits = keyBits<Key>(sign);
+  Key mask = ((Key)1 << bits) - 1;
+  Key flip = sign ? (Key)1 << (bits - 1) : 0;
+  Key toReturn = key;
+  for (; i <= j; ++i, --j) {
+    int shiftI = (n - 1 - i) * bits;
+    int shiftJ = (n - 1 - j) * bits;
+    Key fieldI = ((key >> shiftI) & mask) ^ flip;
+    Key fieldJ = ((key >> shiftJ) & mask) ^ flip;
+    toReturn &= ~((mask << shiftI) | (mask << shiftJ));
+    toReturn |= (fieldJ << shiftI) | (fieldI << shiftJ);
+  }
+  return toReturn;
+}
+
+template <>
+inline __uint64_t keyInversion<__uint64_t>(const int n, const bool sign, const __uint64_t key, int i, int j) {
+  return permutationInversion(n, sign, key, i, j);
+}
+
+// Hash functor of the keys (for unordered containers and hash tables): the
+// finalizer of MurmurHash3, applied to both halves of the 128-bit keys.
+struct KeyHash {
+  static inline __uint64_t mix(__uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+  }
+  size_t operator()(const __uint64_t key) const {
+    return mix(key);
+  }
+  size_t operator()(const wide_key key) const {
+    return mix((__uint64_t)key ^ mix((__uint64_t)(key >> 64)));
+  }
+};
+
+#endif // __LINEAR_KEYS__
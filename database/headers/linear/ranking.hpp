@@ -0,0 +1,106 @@
+/******************************************************************************/
+/*                                                                            */
+/*   This file is part of SWI-LS.                                             */
+/*                                                                            */
+/*   SWI-LS is free software: you can redistribute it and/or modify           */
+/*   it under the terms of the GNU General Public License as published by     */
+/*   the Free Software Foundation, either version 2 of the License, or        */
+/*   any later version.                                                       */
+/*                                                                            */
+/*   SWI-LS is distributed in the hope that it will be useful,                */
+/*   but WITHOUT ANY WARRANTY; without even the implied warranty of           */
+/*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            */
+/*   GNU General Public License for more details.                             */
+/*                                                                            */
+/*   You should have received a copy of the GNU General Public License        */
+/*   along with SWI-LS.  If not, see <http://www.gnu.org/licenses/>.          */
+/*                                                                            */
+/******************************************************************************/
+
+/* ************************************************************************** */
+/* Perfect ranking of signed and unsigned linear permutations                 */
+/* ************************************************************************** */
+
+#ifndef __LINEAR_RANKING__
+#define __LINEAR_RANKING__
+
+#include <cinttypes>
+
+// The rank of a permutation is its index in the lexicographic order of the
+// packed (integer) representation used by linear/signed.hpp and
+// linear/unsigned.hpp. Each position is a digit of a mixed radix number: for
+// unsigned permutations the digit is the number of smaller elements not used
+// yet (Lehmer code), for signed permutations the sign is folded into the digit
+// (negative elements come after all positive ones, as in the packed format).
+// Hence ranks go from 0 (identity) to n! - 1 (unsigned) or n! 2^n - 1 (signed)
+// and sorting by rank is the same as sorting by packed permutation.
+// These functions do not include linear/signed.hpp or linear/unsigned.hpp,
+// which fix the type of the permutations at compile time, so the sign and the
+// size are given as arguments. The headers built on them (the other ones of
+// this directory and the ones of format/) follow the same rule, so a program
+// can handle both types and the heuristics can include them too.
+
+// Number of bits used by each element in the packed representation.
+static inline int packedBits(const bool sign) {
+  return sign ? 5 : 4;
+}
+
+// Returns the number of permutations of size n.
+static inline __uint64_t permutationCount(const int n, const bool sign) {
+  __uint64_t count = 1;
+  for (int i = 2; i <= n; ++i) count *= i;
+  if (sign) count <<= n;
+  return count;
+}
+
+// Returns the rank of the given packed permutation.
+static inline __uint64_t permutationRank(const int n, const bool sign, const __uint64_t intPi) {
+  int bits = packedBits(sign);
+  __uint32_t available = (1u << n) - 1;
+  __uint64_t rank = 0;
+  for (int i = 0; i < n; ++i) {
+    int remaining = n - i;
+    __uint32_t field = (intPi >> ((n - 1 - i) * bits)) & ((1u << bits) - 1);
+    __uint32_t value = field & 15;
+    __uint64_t digit = __builtin_popcount(available & ((1u << value) - 1));
+    if (sign) {
+      if (field & 16) digit += remaining;
+      rank = rank * (2 * remaining) + digit;
+    } else {
+      rank = rank * remaining + digit;
+    }
+    available &= ~(1u << value);
+  }
+  return rank;
+}
+
+// Returns the packed permutation which has the given rank.
+static inline __uint64_t permutationUnrank(const int n, const bool sign, __uint64_t rank) {
+  int bits = packedBits(sign);
+  __uint32_t digits[32];
+  for (int i = n - 1; i >= 0; --i) {
+    __uint32_t radix = sign ? 2 * (n - i) : n - i;
+    digits[i] = rank % radix;
+    rank /= radix;
+  }
+  __uint32_t available = (1u << n) - 1;
+  __uint64_t intPi = 0;
+  for (int i = 0; i < n; ++i) {
+    int remaining = n - i;
+    __uint32_t digit = digits[i];
+    __uint32_t negative = 0;
+    if (sign && digit >= (__uint32_t)remaining) {
+      digit -= remaining;
+      negative = 16;
+    }
+    // Select the digit-th element not used yet
+    __uint32_t candidates = available;
+    while (digit-- > 0) candidates &= candidates - 1;
+    __uint32_t value = __builtin_ctz(candidates);
+    available &= ~(1u << value);
+    intPi = (intPi << bits) | value | negative;
+  }
+  return intPi;
+}
+
+#endif // __LINEAR_RANKING__
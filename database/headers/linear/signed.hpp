@@ -29,6 +29,11 @@
 #include <iostream>
 #include <cinttypes>
 
+#include <linear/ranking.hpp>
+#include <linear/symmetry.hpp>
+#include <linear/swar.hpp>
+#include <linear/keys.hpp>
+
 // Maximum size of a signed permutation.
 #define N_MAX 12
 
@@ -41,75 +46,82 @@
 #define NUMBERS        15
 #define NUMBERSANDSIGN 31
 
+// This header deals with signed permutations.
+#define IS_SIGNED true
+
 // Type which defines a signed element.
 typedef __int16_t element;
 
 // Type used to represent a permutation using only 64 bits.
 typedef __uint64_t permutation_int;
 
+// Maximum size of a permutation kept in 128 bits (wider fields, see linear/keys.hpp).
+#define N_MAX_WIDE 21
+
+// Type used to represent a permutation of up to N_MAX_WIDE elements using 128 bits.
+typedef wide_key permutation_wide;
+
 // Type used to represent a permutation using a vector of signed elements.
 typedef std::vector<element> permutation_vector;
 
 // Converts a permutation in integer format to a permutation into vector format.
 static inline void int_to_vector(const element n, const permutation_int intPi, permutation_vector &vectorPi) {
-  permutation_int aux = intPi;
-  for (element i = n - 1; i >= 0; --i) {
-    element last = (aux & NUMBERS) + 1;
-    element sign = aux & SIGN;
-    if (sign) vectorPi[i] = -last;
-    else vectorPi[i] = last;
-    aux = aux >> N_BITS;
-  }
+  unpackKey(n, IS_SIGNED, intPi, vectorPi);
 }
 
 // Returns a permutation in integer format based on the given permutation (vector format).
-static inline permutation_int vector_to_int(const element n, const permutation_vector pi) {
-  permutation_int aux = 0;
-  for (element i = 0; i < n; ++i) {
-    aux = aux << N_BITS;
-    element e = pi[i];
-    if (e < 0) {
-      e = (-e) - 1;
-      e = e | SIGN;
-    }
-    else {
-      e = e - 1;
-    }
-    aux = aux | e;
-  }
-  return aux;
+static inline permutation_int vector_to_int(const element n, const permutation_vector &pi) {
+  return packKey<permutation_int>(n, IS_SIGNED, pi);
+}
+
+// Converts a permutation in 128-bit integer format to a permutation into vector format.
+static inline void int_to_vector(const element n, const permutation_wide intPi, permutation_vector &vectorPi) {
+  unpackKey(n, IS_SIGNED, intPi, vectorPi);
+}
+
+// Returns a permutation in 128-bit integer format based on the given permutation (vector format).
+static inline permutation_wide vector_to_wide(const element n, const permutation_vector &pi) {
+  return packKey<permutation_wide>(n, IS_SIGNED, pi);
+}
+
+// Returns the number of signed permutations of size n.
+static inline __uint64_t numberOfPermutations(const element n) {
+  return permutationCount(n, IS_SIGNED);
+}
+
+// Returns the rank (position in the lexicographic order) of the given permutation (integer format).
+static inline __uint64_t int_to_rank(const element n, const permutation_int intPi) {
+  return permutationRank(n, IS_SIGNED, intPi);
+}
+
+// Returns the permutation (integer format) which has the given rank.
+static inline permutation_int rank_to_int(const element n, const __uint64_t rank) {
+  return permutationUnrank(n, IS_SIGNED, rank);
+}
+
+// Returns the representative of the symmetry class of the given permutation (integer format).
+static inline permutation_int canonical(const element n, const permutation_int intPi) {
+  return permutationCanonical(n, IS_SIGNED, intPi);
 }
 
 // Fills the given permutation (vector format) with the identity permutation.
-static void identityPermutation(const element n, permutation_vector &pi) {
+static inline void identityPermutation(const element n, permutation_vector &pi) {
   for (element i = 0; i < n; ++i) {
     pi[i] = i + 1;
   }
 }
 
-// Prints the given permutation (vector format).
-static void print(const element n, const permutation_vector pi, std::ostream &ostream) {
-  ostream << pi[0];
-  for (element i = 1; i < n; ++i) {
-    ostream << "," << pi[i];
-  }
+// Applies the given inversion into pi (integer format) and returns the resulting permutation.
+// IMPORTANT: To speed up, this function assumes that 0 <= i <= j <= n - 1.
+static inline permutation_int applyInversionInt(const element n, const element i, const element j, const permutation_int intPi) {
+  return permutationInversion(n, IS_SIGNED, intPi, i, j);
 }
 
-// Applies the given inversion into pi. The permutation sigma will receive the resulting permutation.
-// IMPORTANT: To speed up, this function assumes that i <= j and that the extrimities of the
-// inversion are inside of the permutation (in the interval [0, n - 1].
-static void applyInversion(element i, element j, const permutation_vector pi, permutation_vector &sigma) {
-  // First copy pi to sigma
-  element aux;
-  sigma.assign(pi.begin(), pi.end());
-  // Then, apply the inversion
-  while (i <= j) {
-    aux = sigma[i];
-    sigma[i] = -sigma[j];
-    sigma[j] = -aux;
-    ++i;
-    --j;
-  }
+// Applies the given inversion to the elements of pi (integer format) and returns the
+// resulting permutation: the elements whose absolute value is in the interval
+// [i + 1, j + 1] are reversed and have their signs flipped.
+static inline permutation_int applyElementInversionInt(const element n, const element i, const element j, const permutation_int intPi) {
+  return permutationElementInversion(n, IS_SIGNED, intPi, i, j);
 }
 
 #endif // __LINEAR_SIGNED__
@@ -0,0 +1,104 @@
+/******************************************************************************/
+/*                                                                            */
+/*   This file is part of SWI-LS.                                             */
+/*                                                                            */
+/*   SWI-LS is free software: you can redistribute it and/or modify           */
+/*   it under the terms of the GNU General Public License as published by     */
+/*   the Free Software Foundation, either version 2 of the License, or        */
+/*   any later version.                                                       */
+/*                                                                            */
+/*   SWI-LS is distributed in the hope that it will be useful,                */
+/*   but WITHOUT ANY WARRANTY; without even the implied warranty of           */
+/*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            */
+/*   GNU General Public License for more details.                             */
+/*                                                                            */
+/*   You should have received a copy of the GNU General Public License        */
+/*   along with SWI-LS.  If not, see <http://www.gnu.org/licenses/>.          */
+/*                                                                            */
+/******************************************************************************/
+
+/* ************************************************************************** */
+/* Inversions applied to signed and unsigned permutations in integer format   */
+/* ************************************************************************** */
+
+#ifndef __LINEAR_SWAR__
+#define __LINEAR_SWAR__
+
+#include <cinttypes>
+
+#include <linear/ranking.hpp>
+
+// These kernels apply an inversion to the packed (integer) representation,
+// without going through the vector format. The whole word is first reversed
+// field by field with a few mask and shift operations (a byte swap followed
+// by a nibble swap for the 16 fields of 4 bits, a swap of halves, of groups
+// of three fields and of the outer fields of each group for the 12 fields of
+// 5 bits). Reversing the word maps field f to field F - 1 - f, so a single
+// shift brings the reversed segment to its place and a mask merges it into
+// the original permutation. Signs are flipped with a XOR.
+
+// Masks of the reversal of 12 fields of 5 bits (signed permutations): fields
+// 0 to 5, fields 0 to 2 of each half, field 0 of each group of three fields
+// and the sign bits of all fields.
+#define SWAR_HALF   0x000000003FFFFFFFULL
+#define SWAR_GROUP  0x00001FFFC0007FFFULL
+#define SWAR_FIELD  0x0003E007C00F801FULL
+#define SWAR_MIDDLE 0x007C00F801F003E0ULL
+#define SWAR_SIGNS  0x0842108421084210ULL
+
+// Returns a mask with ones in the first count fields.
+static inline __uint64_t fieldsMask(const int count, const int bits) {
+  if (count * bits >= 64) return ~0ULL;
+  return (1ULL << (count * bits)) - 1;
+}
+
+// Reverses the order of all fields of the word: 16 fields of 4 bits
+// (unsigned) or 12 fields of 5 bits (signed). Returns the number of fields.
+static inline int reverseFields(const bool sign, __uint64_t &word) {
+  if (sign) {
+    word = ((word >> 30) & SWAR_HALF) | ((word & SWAR_HALF) << 30);
+    word = ((word >> 15) & SWAR_GROUP) | ((word & SWAR_GROUP) << 15);
+    word = (word & SWAR_MIDDLE) | ((word >> 10) & SWAR_FIELD) | ((word & SWAR_FIELD) << 10);
+    return 12;
+  }
+  word = __builtin_bswap64(word);
+  word = ((word >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((word & 0x0F0F0F0F0F0F0F0FULL) << 4);
+  return 16;
+}
+
+// Applies the inversion of the positions i to j (0 <= i <= j < n) to the
+// given permutation (integer format) and returns the resulting permutation.
+static inline __uint64_t permutationInversion(const int n, const bool sign, const __uint64_t intPi,
+					      const int i, const int j) {
+  int bits = packedBits(sign);
+  // Fields are numbered from the least significant one
+  int low = n - 1 - j;
+  int high = n - 1 - i;
+  __uint64_t reversed = intPi;
+  int shift = reverseFields(sign, reversed) - 1 - low - high;
+  if (shift >= 0) reversed >>= shift * bits;
+  else reversed <<= -shift * bits;
+  __uint64_t mask = fieldsMask(j - i + 1, bits) << (low * bits);
+  if (sign) reversed ^= SWAR_SIGNS;
+  return (intPi & ~mask) | (reversed & mask);
+}
+
+// Applies the inversion of the elements i + 1 to j + 1 (0 <= i <= j < n) to
+// the given permutation (integer format): these elements are reversed and
+// have their signs flipped. Returns the resulting permutation.
+static inline __uint64_t permutationElementInversion(const int n, const bool sign, const __uint64_t intPi,
+						     const int i, const int j) {
+  int bits = packedBits(sign);
+  __uint64_t toReturn = intPi;
+  for (int f = 0; f < n; ++f) {
+    __uint64_t value = (intPi >> (f * bits)) & 15;
+    if (value >= (__uint64_t)i && value <= (__uint64_t)j) {
+      __uint64_t field = i + j - value;
+      if (sign) field |= ~(intPi >> (f * bits)) & 16;
+      toReturn = (toReturn & ~(fieldsMask(1, bits) << (f * bits))) | (field << (f * bits));
+    }
+  }
+  return toReturn;
+}
+
+#endif // __LINEAR_SWAR__
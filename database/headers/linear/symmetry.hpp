@@ -0,0 +1,91 @@
+/******************************************************************************/
+/*                                                                            */
+/*   This file is part of SWI-LS.                                             */
+/*                                                                            */
+/*   SWI-LS is free software: you can redistribute it and/or modify           */
+/*   it under the terms of the GNU General Public License as published by     */
+/*   the Free Software Foundation, either version 2 of the License, or        */
+/*   any later version.                                                       */
+/*                                                                            */
+/*   SWI-LS is distributed in the hope that it will be useful,                */
+/*   but WITHOUT ANY WARRANTY; without even the implied warranty of           */
+/*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            */
+/*   GNU General Public License for more details.                             */
+/*                                                                            */
+/*   You should have received a copy of the GNU General Public License        */
+/*   along with SWI-LS.  If not, see <http://www.gnu.org/licenses/>.          */
+/*                                                                            */
+/******************************************************************************/
+
+/* ************************************************************************** */
+/* Symmetries of signed and unsigned linear permutations                      */
+/* ************************************************************************** */
+
+#ifndef __LINEAR_SYMMETRY__
+#define __LINEAR_SYMMETRY__
+
+#include <cinttypes>
+#include <algorithm>
+
+#include <linear/ranking.hpp>
+
+// For the SWI-LS problem, the weight of an inversion depends only on the
+// slices of its extremities, which are symmetric around the centre, and every
+// inversion is its own inverse. Hence the distance of a permutation is the
+// same as the distance of its inverse and of its mirror (positions and
+// elements relabelled from the other end, signs kept). A symmetry class has
+// up to four permutations and its representative is the smallest one (integer
+// format).
+
+// Maximum number of permutations of a symmetry class.
+#define CLASS_SIZE 4
+
+// Returns the inverse of the given permutation (integer format).
+static inline __uint64_t permutationInverse(const int n, const bool sign, const __uint64_t intPi) {
+  int bits = packedBits(sign);
+  __uint64_t mask = (1u << bits) - 1;
+  __uint32_t inverse[32];
+  for (int i = 0; i < n; ++i) {
+    __uint32_t field = (intPi >> ((n - 1 - i) * bits)) & mask;
+    inverse[field & 15] = i | (field & 16);
+  }
+  __uint64_t toReturn = 0;
+  for (int i = 0; i < n; ++i)
+    toReturn = (toReturn << bits) | inverse[i];
+  return toReturn;
+}
+
+// Returns the mirror of the given permutation (integer format): the element
+// at position i is the complement of the element at position n - i + 1.
+static inline __uint64_t permutationMirror(const int n, const bool sign, const __uint64_t intPi) {
+  int bits = packedBits(sign);
+  __uint64_t mask = (1u << bits) - 1;
+  __uint64_t toReturn = 0;
+  for (int i = 0; i < n; ++i) {
+    __uint32_t field = (intPi >> (i * bits)) & mask;
+    toReturn = (toReturn << bits) | ((n - 1 - (field & 15)) | (field & 16));
+  }
+  return toReturn;
+}
+
+// Fills members with the (distinct and sorted) permutations of the symmetry
+// class of the given permutation and returns how many they are. The first
+// one is the representative of the class.
+static inline int permutationClass(const int n, const bool sign, const __uint64_t intPi, __uint64_t members[CLASS_SIZE]) {
+  __uint64_t inverse = permutationInverse(n, sign, intPi);
+  members[0] = intPi;
+  members[1] = inverse;
+  members[2] = permutationMirror(n, sign, intPi);
+  members[3] = permutationMirror(n, sign, inverse);
+  std::sort(members, members + CLASS_SIZE);
+  return std::unique(members, members + CLASS_SIZE) - members;
+}
+
+// Returns the representative of the symmetry class of the given permutation.
+static inline __uint64_t permutationCanonical(const int n, const bool sign, const __uint64_t intPi) {
+  __uint64_t inverse = permutationInverse(n, sign, intPi);
+  return std::min(std::min(intPi, inverse),
+		  std::min(permutationMirror(n, sign, intPi), permutationMirror(n, sign, inverse)));
+}
+
+#endif // __LINEAR_SYMMETRY__
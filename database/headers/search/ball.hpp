@@ -0,0 +1,203 @@
+/******************************************************************************/
+/*                                                                            */
+/*   This file is part of SWI-LS.                                             */
+/*                                                                            */
+/*   SWI-LS is free software: you can redistribute it and/or modify           */
+/*   it under the terms of the GNU General Public License as published by     */
+/*   the Free Software Foundation, either version 2 of the License, or        */
+/*   any later version.                                                       */
+/*                                                                            */
+/*   SWI-LS is distributed in the hope that it will be useful,                */
+/*   but WITHOUT ANY WARRANTY; without even the implied warranty of           */
+/*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            */
+/*   GNU General Public License for more details.                             */
+/*                                                                            */
+/*   You should have received a copy of the GNU General Public License        */
+/*   along with SWI-LS.  If not, see <http://www.gnu.org/licenses/>.          */
+/*                                                                            */
+/******************************************************************************/
+
+/* ************************************************************************** */
+/* Dijkstra restricted to the permutations up to a given distance (ball)      */
+/* ************************************************************************** */
+
+#ifndef __SEARCH_BALL__
+#define __SEARCH_BALL__
+
+// IMPORTANT: One of the headers linear/signed.hpp or linear/unsigned.hpp must
+// be included before this one.
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <iostream>
+#include <algorithm>
+
+#include <problem/problem.hpp>
+#include <search/records.hpp>
+#include <search/progress.hpp>
+#include <search/hash_table.hpp>
+#include <search/bucket_queue.hpp>
+
+// Number of permutations of a layer expanded at once by each thread.
+#define BALL_CHUNK 1024
+
+// Initial number of slots of the hash table.
+#define BALL_SLOTS (1 << 20)
+
+// Class BallSearch: It generates the permutations up to a given distance
+// (radius) of the identity, with their distances, for sizes where the whole
+// graph can not be enumerated. Keys have 64 bits (up to N_MAX elements) or
+// 128 bits (up to N_MAX_WIDE elements). The reached permutations are kept in
+// a FlatHashTable and the pending ones in a BucketQueue (stale entries are
+// skipped by comparing their distance with the one in the table). Each layer
+// is expanded in parallel, in batches which can not fill more than half of
+// the table, and the table grows between batches. Layers are written sorted
+// by permutation, so the output is the beginning of the output of the other
+// searches, and their sizes are reported in the standard error.
+template <typename Key>
+class BallSearch {
+
+private:
+
+  // Permutation size
+  element n;
+
+  // Number of threads used to expand each layer
+  int threads;
+
+  // Maximum distance
+  int radius;
+
+  // List of inversions and its maximum weight
+  inversion_list list;
+  weight maxWeight;
+
+  // Reached permutations and their distances
+  FlatHashTable<Key> table;
+
+  // Layer being expanded and the next chunk of it
+  std::vector<Key> layer;
+  int currentDistance;
+  std::atomic<__uint64_t> nextChunk;
+
+  // Progress records (NULL if they are not wanted)
+  Progress *progress;
+
+  // Expands chunks of the layer in the interval [begin, end). The
+  // permutations reached with a new or shorter distance are kept in found,
+  // by distance minus the distance of the layer.
+  void expandBatch(const __uint64_t begin, const __uint64_t end, std::vector<std::vector<Key> > &found) {
+    while (true) {
+      __uint64_t first = begin + nextChunk.fetch_add(BALL_CHUNK);
+      if (first >= end) break;
+      __uint64_t last = std::min(first + BALL_CHUNK, end);
+      for (__uint64_t index = first; index < last; ++index) {
+	Key key = layer[index];
+	for (inversion_list_it it = list.begin(); it != list.end(); ++it) {
+	  int newDistance = currentDistance + (*it).w;
+	  if (newDistance > radius) continue;
+	  Key sigma = keyInversion(n, IS_SIGNED, key, (*it).i, (*it).j);
+	  if (table.insert(sigma, newDistance))
+	    found[(*it).w].push_back(sigma);
+	}
+      }
+      if (progress) progress->advance(last - first);
+    }
+  }
+
+public:
+
+  // Constructor
+  BallSearch(const element N, const int T, const int R) : table(BALL_SLOTS) {
+    n = N;
+    threads = std::max(T, 1);
+    radius = R;
+    list = getPossibleInversions(SWI_LS, n, IS_SIGNED);
+    maxWeight = 0;
+    for (inversion_list_it it = list.begin(); it != list.end(); ++it)
+      maxWeight = std::max(maxWeight, (*it).w);
+    currentDistance = 0;
+    progress = NULL;
+  }
+
+  // Reports the progress of the search in the given records.
+  void setProgress(Progress *P) {
+    progress = P;
+  }
+
+  // Does the real job.
+  void run(RecordWriter &output) {
+
+    if (radius + maxWeight >= FlatHashTable<Key>::MISSING) {
+      std::cerr << std::endl << "ERROR!!! Distance overflow." << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+    }
+
+    // Start with the identity permutation
+    permutation_vector vectorPi = permutation_vector(n);
+    identityPermutation(n, vectorPi);
+    Key identity = packKey<Key>(n, IS_SIGNED, vectorPi);
+    BucketQueue<Key> queue(maxWeight);
+    table.insert(identity, 0);
+    queue.push(0, identity);
+
+    std::vector<std::vector<std::vector<Key> > > found(threads);
+    __uint64_t total = 0;
+
+    while (!queue.empty()) {
+
+      currentDistance = queue.pop(layer);
+      if (currentDistance > radius) break;
+
+      // Remove stale entries and write the layer
+      size_t size = 0;
+      for (size_t index = 0; index < layer.size(); ++index)
+	if (table.find(layer[index]) == currentDistance)
+	  layer[size++] = layer[index];
+      layer.resize(size);
+      if (layer.empty()) continue;
+      std::sort(layer.begin(), layer.end());
+      for (size_t index = 0; index < layer.size(); ++index)
+	output.write(layer[index], currentDistance);
+      output.endLayer();
+      total += layer.size();
+      std::cerr << "Distance " << currentDistance << ": " << layer.size() << " permutations (";
+      std::cerr << total << " up to this distance)" << std::endl;
+      if (progress) progress->startLayer(currentDistance, layer.size(), queue.size());
+
+      // Expand the layer in batches which fit in the table
+      __uint64_t begin = 0;
+      while (begin < layer.size() && currentDistance < radius) {
+	__uint64_t room = table.slots() / 2 > table.size() ? table.slots() / 2 - table.size() : 0;
+	__uint64_t batch = std::min((__uint64_t)layer.size() - begin, room / list.size());
+	if (batch < BALL_CHUNK && batch < layer.size() - begin) {
+	  table.grow();
+	  continue;
+	}
+	for (int t = 0; t < threads; ++t)
+	  found[t].assign(maxWeight + 1, std::vector<Key>());
+	nextChunk = 0;
+	if (threads == 1) {
+	  expandBatch(begin, begin + batch, found[0]);
+	} else {
+	  std::vector<std::thread> workers;
+	  for (int t = 0; t < threads; ++t)
+	    workers.push_back(std::thread(&BallSearch::expandBatch, this, begin, begin + batch, std::ref(found[t])));
+	  for (int t = 0; t < threads; ++t)
+	    workers[t].join();
+	}
+	for (int t = 0; t < threads; ++t)
+	  for (int w = 1; w <= maxWeight; ++w)
+	    for (size_t index = 0; index < found[t][w].size(); ++index)
+	      queue.push(currentDistance + w, found[t][w][index]);
+	begin += batch;
+      }
+      if (progress) progress->endLayer(queue.size(), output.written());
+    }
+
+  }
+
+};
+
+#endif // __SEARCH_BALL__
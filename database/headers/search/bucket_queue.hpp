@@ -0,0 +1,79 @@
+/******************************************************************************/
+/*                                                                            */
+/*   This file is part of SWI-LS.                                             */
+/*                                                                            */
+/*   SWI-LS is free software: you can redistribute it and/or modify           */
+/*   it under the terms of the GNU General Public License as published by     */
+/*   the Free Software Foundation, either version 2 of the License, or        */
+/*   any later version.                                                       */
+/*                                                                            */
+/*   SWI-LS is distributed in the hope that it will be useful,                */
+/*   but WITHOUT ANY WARRANTY; without even the implied warranty of           */
+/*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            */
+/*   GNU General Public License for more details.                             */
+/*                                                                            */
+/*   You should have received a copy of the GNU General Public License        */
+/*   along with SWI-LS.  If not, see <http://www.gnu.org/licenses/>.          */
+/*                                                                            */
+/******************************************************************************/
+
+/* ************************************************************************** */
+/* Circular bucket queue (Dial) for small integer distances                   */
+/* ************************************************************************** */
+
+#ifndef __SEARCH_BUCKET_QUEUE__
+#define __SEARCH_BUCKET_QUEUE__
+
+#include <vector>
+#include <cinttypes>
+
+// Class BucketQueue: Priority queue for Dijkstra with integer edge weights
+// in the interval [1, maxWeight]. Since every tentative distance lies in
+// [current, current + maxWeight], maxWeight + 1 buckets indexed by distance
+// modulo maxWeight + 1 are enough. Decrease-key is done by pushing the element
+// again: the caller must skip stale entries when the bucket is popped.
+template <typename T>
+class BucketQueue {
+
+private:
+
+  // Buckets (indexed by the distance modulo the number of buckets)
+  std::vector<std::vector<T> > buckets;
+
+  // Distance of the lowest bucket which may be non-empty
+  int current;
+
+  // Number of elements (stale entries included) kept by all buckets
+  __uint64_t elements;
+
+public:
+
+  // Constructor
+  BucketQueue(int maxWeight) : buckets(maxWeight + 1), current(0), elements(0) {}
+
+  // Returns true if there are no more elements in the queue
+  bool empty() const { return elements == 0; }
+
+  // Returns the number of elements (stale entries included) in the queue
+  __uint64_t size() const { return elements; }
+
+  // Inserts the element with the given distance
+  // IMPORTANT: The distance must be in the interval [current, current + maxWeight].
+  void push(int distance, const T &element) {
+    buckets[distance % buckets.size()].push_back(element);
+    ++elements;
+  }
+
+  // Moves the content of the lowest non-empty bucket into layer and returns
+  // its distance. The queue must not be empty.
+  int pop(std::vector<T> &layer) {
+    while (buckets[current % buckets.size()].empty()) ++current;
+    layer.clear();
+    layer.swap(buckets[current % buckets.size()]);
+    elements -= layer.size();
+    return current;
+  }
+
+};
+
+#endif // __SEARCH_BUCKET_QUEUE__
@@ -0,0 +1,483 @@
+/******************************************************************************/
+/*                                                                            */
+/*   This file is part of SWI-LS.                                             */
+/*                                                                            */
+/*   SWI-LS is free software: you can redistribute it and/or modify           */
+/*   it under the terms of the GNU General Public License as published by     */
+/*   the Free Software Foundation, either version 2 of the License, or        */
+/*   any later version.                                                       */
+/*                                                                            */
+/*   SWI-LS is distributed in the hope that it will be useful,                */
+/*   but WITHOUT ANY WARRANTY; without even the implied warranty of           */
+/*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            */
+/*   GNU General Public License for more details.                             */
+/*                                                                            */
+/*   You should have received a copy of the GNU General Public License        */
+/*   along with SWI-LS.  If not, see <http://www.gnu.org/licenses/>.          */
+/*                                                                            */
+/******************************************************************************/
+
+/* ************************************************************************** */
+/* Dijkstra over all permutations using a dense rank-indexed distance array   */
+/* ************************************************************************** */
+
+#ifndef __SEARCH_DENSE__
+#define __SEARCH_DENSE__
+
+// IMPORTANT: One of the headers linear/signed.hpp or linear/unsigned.hpp must
+// be included before this one.
+
+#include <new>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <algorithm>
+
+#include <problem/problem.hpp>
+#include <search/records.hpp>
+#include <search/progress.hpp>
+#include <search/modular.hpp>
+#include <format/compact.hpp>
+#include <format/policy.hpp>
+
+// Distance of the permutations which were not reached yet.
+#define UNREACHED 255
+
+// Number of ranks processed at once by each thread.
+#define CHUNK_SIZE 65536
+
+// First word of the checkpoint files ("SWILSCK2").
+#define CHECKPOINT_MAGIC 0x324b43534c495753ULL
+
+// Class DenseSearch: It generates the database of all permutations of size n
+// (Dijkstra from the identity), writing them in non-decreasing order of
+// distance.
+// The tentative distances are kept in a flat array indexed by rank (see
+// search/modular.hpp), with 3 or 4 bits per permutation (distances modulo
+// maxWeight + 1) or, when the distances are needed after the search, one
+// byte per permutation. Since inversion weights are in the interval
+// [1, maxWeight], the layer of distance d is final when all layers before it
+// were expanded, and it is found by scanning the array. Only the number of
+// pending permutations of each distance (modulo maxWeight + 1) is kept. As the
+// rank order is the lexicographic order of the integer format, each layer is
+// written sorted by permutation.
+// Each layer is expanded in parallel: threads take chunks of ranks and lower
+// the distances of the neighbours with atomic operations. The layer itself is
+// written by the main thread at the same time, so the output does not depend
+// on the number of threads.
+// With the symmetry flag, only the representatives of the symmetry classes
+// (see linear/symmetry.hpp) are reached and written. The neighbours of a class
+// are the neighbours of the representative by inversions applied to its
+// positions and to its elements (the latter are the neighbours of its
+// inverse); the mirrored permutations need nothing else, since the mirror of
+// an inversion is also an inversion with the same weight.
+// Long generations may save checkpoints at the end of the layers: the whole
+// state of the search is the distance array, the pending counters, the next
+// layer and the size of the output file. A resumed generation truncates the
+// output to that size and continues from the next layer.
+// The progress of the search may be reported (see search/progress.hpp).
+// At the end, the distance array may also be written as a compact database
+// (see format/compact.hpp), in which case no records have to be written, and
+// used to find the optimal inversion of each permutation (policy table, see
+// format/policy.hpp).
+class DenseSearch {
+
+private:
+
+  // Permutation size
+  element n;
+
+  // Number of threads used to expand each layer
+  int threads;
+
+  // Flag: only representatives of symmetry classes
+  bool symmetry;
+
+  // List of inversions and its maximum weight
+  inversion_list list;
+  weight maxWeight;
+
+  // Distances of all permutations
+  __uint64_t states;
+  DistanceArray *distances;
+
+  // Number of permutations of each distance
+  std::vector<__uint64_t> layerSizes;
+
+  // Number of pending (reached but not expanded) permutations of each
+  // distance (modulo maxWeight + 1) and of all distances
+  std::vector<__uint64_t> pending;
+  __uint64_t totalPending;
+
+  // Layer being expanded and the next chunk of ranks to be processed
+  int currentDistance;
+  std::atomic<__uint64_t> nextChunk;
+
+  // Checkpoint file (empty if there are no checkpoints), minimum interval
+  // between checkpoints and time of the last one
+  std::string checkpointFile;
+  std::chrono::seconds checkpointInterval;
+  std::chrono::steady_clock::time_point lastCheckpoint;
+
+  // Flag: the state was loaded from a checkpoint
+  bool restored;
+
+  // Progress records (NULL if they are not wanted)
+  Progress *progress;
+
+  // Reaches the given permutation with the given distance, counting the
+  // changes of the pending counters in delta.
+  void reach(const permutation_int intSigma, const int newDistance, std::vector<__int64_t> &delta) {
+    int oldDistance = distances->relax(int_to_rank(n, intSigma), currentDistance, newDistance);
+    if (oldDistance == FIRST_REACH) {
+      // First time this permutation appears
+      delta[newDistance % (maxWeight + 1)]++;
+      delta[maxWeight + 1]++;
+    } else if (oldDistance >= 0) {
+      // Shorter path to a pending permutation
+      delta[oldDistance % (maxWeight + 1)]--;
+      delta[newDistance % (maxWeight + 1)]++;
+    }
+  }
+
+  // Expands chunks of the current layer until there are no more chunks. The
+  // changes of the pending counters are accumulated in delta (the last
+  // position keeps the number of permutations reached for the first time).
+  void expandLayer(std::vector<__int64_t> &delta) {
+    int layer = distances->layerCode(currentDistance);
+    while (true) {
+      __uint64_t begin = nextChunk.fetch_add(CHUNK_SIZE);
+      if (begin >= states) break;
+      __uint64_t end = std::min(begin + CHUNK_SIZE, states);
+      __uint64_t expanded = 0;
+      for (__uint64_t rank = begin; rank < end; ++rank) {
+	if (distances->code(rank) != layer) continue;
+	++expanded;
+	// Try all inversions over the permutation (integer format)
+	permutation_int intPi = rank_to_int(n, rank);
+	for (inversion_list_it it = list.begin(); it != list.end(); ++it) {
+	  int newDistance = currentDistance + (*it).w;
+	  permutation_int intSigma = applyInversionInt(n, (*it).i, (*it).j, intPi);
+	  if (symmetry) {
+	    reach(canonical(n, intSigma), newDistance, delta);
+	    intSigma = applyElementInversionInt(n, (*it).i, (*it).j, intPi);
+	    reach(canonical(n, intSigma), newDistance, delta);
+	  } else {
+	    reach(intSigma, newDistance, delta);
+	  }
+	}
+      }
+      if (progress) progress->advance(expanded);
+    }
+  }
+
+  // Writes the permutations of the current layer (in rank order)
+  void writeLayer(RecordWriter &output) {
+    int layer = distances->layerCode(currentDistance);
+    for (__uint64_t rank = 0; rank < states; ++rank) {
+      if (distances->code(rank) == layer)
+	output.write(rank_to_int(n, rank), currentDistance);
+    }
+    output.endLayer();
+  }
+
+  // Finalizes chunks of words of the current layer until there are no more
+  // chunks (see DistanceArray::finalize)
+  void finalizeLayer() {
+    while (true) {
+      __uint64_t begin = nextChunk.fetch_add(CHUNK_SIZE);
+      if (begin >= distances->wordCount()) break;
+      distances->finalize(begin, std::min(begin + CHUNK_SIZE, distances->wordCount()), currentDistance);
+    }
+  }
+
+  // Header of the checkpoint files
+  struct CheckpointHeader {
+    __uint64_t magic;
+    __int32_t n;
+    __int32_t sign;
+    __int32_t symmetry;
+    __int32_t nextDistance;
+    __int32_t bits;
+    __int32_t reserved;
+    __uint64_t states;
+    __uint64_t totalPending;
+    __int64_t offset;
+  };
+
+  // Saves the state of the search before the given layer. The checkpoint is
+  // written to a temporary file which replaces the previous one only when it
+  // is complete.
+  void saveCheckpoint(const int nextDistance, const __int64_t offset) {
+    CheckpointHeader header;
+    header.magic = CHECKPOINT_MAGIC;
+    header.n = n;
+    header.sign = IS_SIGNED;
+    header.symmetry = symmetry;
+    header.nextDistance = nextDistance;
+    header.bits = distances->codeBits();
+    header.reserved = 0;
+    header.states = states;
+    header.totalPending = totalPending;
+    header.offset = offset;
+    std::string name = checkpointFile + ".new";
+    std::ofstream file(name, std::ios::out | std::ios::trunc | std::ios::binary);
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(pending.data()), pending.size() * sizeof(__uint64_t));
+    file.write(reinterpret_cast<const char *>(layerSizes.data()), layerSizes.size() * sizeof(__uint64_t));
+    file.write(distances->raw(), distances->size());
+    file.close();
+    if (!file.good() || std::rename(name.c_str(), checkpointFile.c_str()) != 0) {
+      std::cerr << std::endl << "ERROR!!! Could not write file " << checkpointFile << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    lastCheckpoint = std::chrono::steady_clock::now();
+  }
+
+  // Returns the distance of the given permutation (integer format). With the
+  // symmetry flag, it is the distance of the representative of its class.
+  int distanceOf(const permutation_int intPi) const {
+    if (symmetry) return distances->distance(int_to_rank(n, canonical(n, intPi)));
+    return distances->distance(int_to_rank(n, intPi));
+  }
+
+  // Stops the program if the distances of the search were not kept
+  void requireDistances() const {
+    if (distances->isModular()) {
+      std::cerr << std::endl << "ERROR!!! The distances of the search were not kept." << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  // Finds the optimal inversions of the ranks in the interval [begin, end).
+  void computePolicy(const __uint64_t begin, const __uint64_t end, __uint8_t* policy) const {
+    for (__uint64_t rank = begin; rank < end; ++rank) {
+      permutation_int intPi = rank_to_int(n, rank);
+      int distance = distanceOf(intPi);
+      policy[rank - begin] = NO_INVERSION;
+      if (distance == 0) continue;
+      for (size_t k = 0; k < list.size(); ++k) {
+	if (distanceOf(applyInversionInt(n, list[k].i, list[k].j, intPi)) + list[k].w == distance) {
+	  policy[rank - begin] = k;
+	  break;
+	}
+      }
+    }
+  }
+
+public:
+
+  // Constructor. With the modular flag, the distances of the permutations are
+  // not kept after their layers (no compact databases or policy tables).
+  DenseSearch(const element N, const int T, const bool S, const bool M) {
+    n = N;
+    threads = std::max(T, 1);
+    symmetry = S;
+    list = getPossibleInversions(SWI_LS, n, IS_SIGNED);
+    maxWeight = 0;
+    for (inversion_list_it it = list.begin(); it != list.end(); ++it)
+      maxWeight = std::max(maxWeight, (*it).w);
+    states = numberOfPermutations(n);
+    distances = new DistanceArray(states, maxWeight, M);
+    layerSizes = std::vector<__uint64_t>(UNREACHED, 0);
+    pending = std::vector<__uint64_t>(maxWeight + 1, 0);
+    totalPending = 0;
+    currentDistance = 0;
+    checkpointInterval = std::chrono::seconds(0);
+    restored = false;
+    progress = NULL;
+  }
+
+  // Destructor
+  ~DenseSearch() {
+    delete distances;
+  }
+
+  // Saves checkpoints in the given file, at the end of the first layer
+  // finished after each interval (in seconds).
+  void setCheckpoint(const std::string file, const int interval) {
+    checkpointFile = file;
+    checkpointInterval = std::chrono::seconds(interval);
+    lastCheckpoint = std::chrono::steady_clock::now();
+  }
+
+  // Reports the progress of the search in the given records.
+  void setProgress(Progress *P) {
+    progress = P;
+  }
+
+  // Loads the state of the search from the given checkpoint file. Returns
+  // the size of the output file when the checkpoint was saved.
+  __int64_t restore(const std::string file) {
+    std::ifstream infile(file, std::ios::in | std::ios::binary);
+    if (!infile.is_open()) {
+      std::cerr << std::endl << "ERROR!!! Could not open file " << file << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    CheckpointHeader header;
+    infile.read(reinterpret_cast<char *>(&header), sizeof(header));
+    if (!infile.good() || header.magic != CHECKPOINT_MAGIC) {
+      std::cerr << std::endl << "ERROR!!! Invalid checkpoint file " << file << "." << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    if (header.n != n || header.sign != IS_SIGNED || header.symmetry != symmetry || header.states != states ||
+	header.bits != distances->codeBits()) {
+      std::cerr << std::endl << "ERROR!!! The checkpoint file " << file;
+      std::cerr << " was saved by a different generation." << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    infile.read(reinterpret_cast<char *>(pending.data()), pending.size() * sizeof(__uint64_t));
+    infile.read(reinterpret_cast<char *>(layerSizes.data()), layerSizes.size() * sizeof(__uint64_t));
+    infile.read(distances->raw(), distances->size());
+    if (!infile.good()) {
+      std::cerr << std::endl << "ERROR!!! Truncated checkpoint file " << file << "." << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    totalPending = header.totalPending;
+    currentDistance = header.nextDistance;
+    restored = true;
+    return header.offset;
+  }
+
+  // Does the real job. The records are written in the given output (if any).
+  void run(RecordWriter *output) {
+
+    // The identity permutation has rank 0
+    if (!restored) {
+      distances->set(0, 0);
+      pending[0] = 1;
+      totalPending = 1;
+      currentDistance = 0;
+    }
+
+    // Layers generated before the checkpoint
+    if (restored && progress) {
+      for (int d = 0; d < currentDistance; ++d)
+	progress->count(d, layerSizes[d]);
+    }
+
+    std::vector<std::vector<__int64_t> > delta = std::vector<std::vector<__int64_t> >(threads);
+
+    for (; totalPending > 0; ++currentDistance) {
+
+      __uint64_t &layerSize = pending[currentDistance % (maxWeight + 1)];
+      if (layerSize == 0) continue;
+      totalPending -= layerSize;
+      layerSizes[currentDistance] = layerSize;
+      if (progress) progress->startLayer(currentDistance, layerSize, totalPending);
+      layerSize = 0;
+
+      if (currentDistance + maxWeight >= UNREACHED) {
+	std::cerr << std::endl << "ERROR!!! Distance overflow." << std::endl << std::endl;
+	exit(EXIT_FAILURE);
+      }
+
+      // Expand the layer while it is written
+      for (int t = 0; t < threads; ++t)
+	delta[t].assign(maxWeight + 2, 0);
+      nextChunk = 0;
+      if (threads == 1) {
+	if (output) writeLayer(*output);
+	expandLayer(delta[0]);
+      } else {
+	std::vector<std::thread> workers;
+	for (int t = 0; t < threads; ++t)
+	  workers.push_back(std::thread(&DenseSearch::expandLayer, this, std::ref(delta[t])));
+	if (output) writeLayer(*output);
+	for (int t = 0; t < threads; ++t)
+	  workers[t].join();
+      }
+
+      // The layer is final (its distance is lost in the modular encoding)
+      nextChunk = 0;
+      if (threads == 1 || !distances->isModular()) {
+	finalizeLayer();
+      } else {
+	std::vector<std::thread> workers;
+	for (int t = 0; t < threads; ++t)
+	  workers.push_back(std::thread(&DenseSearch::finalizeLayer, this));
+	for (int t = 0; t < threads; ++t)
+	  workers[t].join();
+      }
+
+      // Update the pending counters
+      for (int t = 0; t < threads; ++t) {
+	for (int w = 0; w <= maxWeight; ++w)
+	  pending[w] += delta[t][w];
+	totalPending += delta[t][maxWeight + 1];
+      }
+      if (progress) progress->endLayer(totalPending, output ? output->written() : 0);
+
+      // Save a checkpoint (not needed after the last layer)
+      if (!checkpointFile.empty() && totalPending > 0 &&
+	  std::chrono::steady_clock::now() - lastCheckpoint >= checkpointInterval)
+	saveCheckpoint(currentDistance + 1, output ? output->position() : 0);
+    }
+
+    // The generation is complete
+    if (!checkpointFile.empty())
+      std::remove(checkpointFile.c_str());
+  }
+
+  // Writes the distances of all permutations as a compact database. With the
+  // symmetry flag, the distance of each permutation is the one of the
+  // representative of its class.
+  void writeCompact(const std::string file) const {
+    requireDistances();
+    int maxDistance = 0;
+    for (__uint64_t rank = 0; rank < states; ++rank)
+      if (distances->reached(rank))
+	maxDistance = std::max(maxDistance, distances->distance(rank));
+    CompactWriter compact(file, n, IS_SIGNED, maxDistance);
+    for (__uint64_t rank = 0; rank < states; ++rank)
+      compact.write(symmetry ? distanceOf(rank_to_int(n, rank)) : distances->distance(rank));
+    compact.close();
+  }
+
+  // Writes the policy table of all permutations. Blocks of ranks are split
+  // among the threads and written in order.
+  void writePolicy(const std::string file) const {
+    requireDistances();
+    std::ofstream outfile(file, std::ios::out | std::ios::trunc | std::ios::binary);
+    if (!outfile.is_open()) {
+      std::cerr << std::endl << "ERROR!!! Could not open file " << file << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    PolicyHeader header;
+    header.magic = POLICY_MAGIC;
+    header.n = n;
+    header.sign = IS_SIGNED;
+    header.inversions = list.size();
+    header.reserved = 0;
+    header.count = states;
+    outfile.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+    __uint64_t length = (__uint64_t)threads * CHUNK_SIZE;
+    std::vector<__uint8_t> policy(length);
+    for (__uint64_t begin = 0; begin < states; begin += length) {
+      __uint64_t end = std::min(begin + length, states);
+      std::vector<std::thread> workers;
+      for (__uint64_t first = begin; first < end; first += CHUNK_SIZE) {
+	__uint64_t last = std::min(first + CHUNK_SIZE, end);
+	workers.push_back(std::thread(&DenseSearch::computePolicy, this, first, last, &policy[first - begin]));
+      }
+      for (size_t t = 0; t < workers.size(); ++t)
+	workers[t].join();
+      outfile.write(reinterpret_cast<const char *>(policy.data()), end - begin);
+    }
+
+    outfile.close();
+    if (!outfile.good()) {
+      std::cerr << std::endl << "ERROR!!! Could not write file " << file << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+    }
+  }
+
+};
+
+#endif // __SEARCH_DENSE__
@@ -0,0 +1,634 @@
+/******************************************************************************/
+/*                                                                            */
+/*   This file is part of SWI-LS.                                             */
+/*                                                                            */
+/*   SWI-LS is free software: you can redistribute it and/or modify           */
+/*   it under the terms of the GNU General Public License as published by     */
+/*   the Free Software Foundation, either version 2 of the License, or        */
+/*   any later version.                                                       */
+/*                                                                            */
+/*   SWI-LS is distributed in the hope that it will be useful,                */
+/*   but WITHOUT ANY WARRANTY; without even the implied warranty of           */
+/*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            */
+/*   GNU General Public License for more details.                             */
+/*                                                                            */
+/*   You should have received a copy of the GNU General Public License        */
+/*   along with SWI-LS.  If not, see <http://www.gnu.org/licenses/>.          */
+/*                                                                            */
+/******************************************************************************/
+
+/* ************************************************************************** */
+/* Dijkstra over all permutations using sorted run files (external memory)    */
+/* ************************************************************************** */
+
+#ifndef __SEARCH_EXTERNAL__
+#define __SEARCH_EXTERNAL__
+
+// IMPORTANT: One of the headers linear/signed.hpp or linear/unsigned.hpp must
+// be included before this one.
+
+#include <mutex>
+#include <queue>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdio>
+#include <fstream>
+#include <algorithm>
+#include <condition_variable>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <problem/problem.hpp>
+#include <search/records.hpp>
+#include <search/progress.hpp>
+
+// Minimum number of permutations kept by the buffer of each file reader.
+#define MIN_READ_BUFFER 1024
+
+// Commands sent to the workers of a PartitionedSearch (see serve).
+#define PARTITION_FINALIZE 0
+#define PARTITION_EXPAND   1
+#define PARTITION_STOP     2
+
+// Interval between the checks of the files of the spool directory of a
+// PartitionedSearch, in microseconds.
+#define PARTITION_POLL 10000
+
+// Interval between the heartbeats of the workers of a PartitionedSearch, in
+// seconds.
+#define PARTITION_HEARTBEAT 5
+
+// Number of values of the description of a PartitionedSearch (file search of
+// the spool directory): size, symmetry flag, number of partitions and nonce.
+#define PARTITION_SEARCH 4
+
+// Name of the file which keeps the layer of the given distance, inside of the
+// given directory
+static inline std::string layerFileName(const std::string &directory, const int distance) {
+  return directory + "/layer-" + std::to_string((long long int)distance);
+}
+
+// Name of the marker file of the given command of a PartitionedSearch, inside
+// of the spool directory
+static inline std::string commandFileName(const std::string &spool, const int type, const int distance) {
+  static const char *names[] = { "/finalize-", "/expand-", "/stop-" };
+  return spool + names[type] + std::to_string((long long int)distance);
+}
+
+// Name of the file with the reply of the given worker to a command
+static inline std::string replyFileName(const std::string &spool, const int type, const int distance,
+					const int worker) {
+  return commandFileName(spool, type, distance) + ".done-" + std::to_string((long long int)worker);
+}
+
+// Name of the file with the heartbeats of the given worker (nonce of the
+// search and a counter, rewritten every PARTITION_HEARTBEAT seconds)
+static inline std::string heartbeatFileName(const std::string &spool, const int worker) {
+  return spool + "/alive-" + std::to_string((long long int)worker);
+}
+
+// Writes a file of the spool directory with the given counters. The file is
+// renamed once written, so the other processes never see it incomplete.
+static inline void writeSpoolFile(const std::string &name, const __uint64_t *values, const int count) {
+  std::string temporary = name + ".tmp";
+  std::ofstream file(temporary, std::ios::out | std::ios::trunc);
+  for (int v = 0; v < count; ++v)
+    file << values[v] << std::endl;
+  file.close();
+  if (!file.good() || std::rename(temporary.c_str(), name.c_str()) != 0) {
+    std::cerr << std::endl << "ERROR!!! Could not write file " << name << std::endl << std::endl;
+    exit(EXIT_FAILURE);
+  }
+}
+
+// Reads the counters of a file of the spool directory. Returns false if the
+// file does not exist (yet).
+static inline bool readSpoolFile(const std::string &name, __uint64_t *values, const int count) {
+  std::ifstream file(name);
+  if (!file.is_open()) return false;
+  for (int v = 0; v < count; ++v)
+    file >> values[v];
+  if (file.fail()) {
+    std::cerr << std::endl << "ERROR!!! Invalid file " << name << std::endl << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  return true;
+}
+
+// Returns true if the given file of the spool directory exists
+static inline bool spoolFileExists(const std::string &name) {
+  struct stat info;
+  return stat(name.c_str(), &info) == 0;
+}
+
+// Class KeyReader: Sequential reader of a file of sorted permutations
+// (integer format).
+class KeyReader {
+
+private:
+
+  std::ifstream file;
+  std::vector<permutation_int> buffer;
+  size_t index;
+  size_t size;
+
+  void fill() {
+    file.read(reinterpret_cast<char *>(buffer.data()), buffer.size() * sizeof(permutation_int));
+    size = file.gcount() / sizeof(permutation_int);
+    index = 0;
+  }
+
+public:
+
+  // Constructor
+  KeyReader(const std::string name, const size_t length) {
+    buffer = std::vector<permutation_int>(length);
+    file.open(name, std::ios::in | std::ios::binary);
+    size = 0;
+    index = 0;
+    if (file.is_open()) fill();
+  }
+
+  // Returns true while there are permutations to be read
+  bool valid() const { return index < size; }
+
+  // Returns the current permutation
+  permutation_int key() const { return buffer[index]; }
+
+  // Moves to the next permutation
+  void next() { if (++index == size) fill(); }
+
+};
+
+// Class ExternalSearch: It generates the same database as DenseSearch, but
+// keeping most of the search state on disk, inside of a temporary directory.
+// Permutations generated while a layer is expanded are kept in one buffer per
+// distance; when the buffers reach half of the memory budget, they are sorted
+// and written as run files. The layer of distance d is finalized by merging
+// its runs and removing the permutations found in the previous layers. Since
+// the graph is undirected and the weights are at most maxWeight, only the
+// last 2 maxWeight layers (kept as sorted files) have to be checked. Layers
+// are sorted by permutation, so the output is the same as the one of the
+// in-memory search (symmetry classes are handled as in DenseSearch).
+//
+// The search may also own only a range of ranks (a partition), as a worker of
+// a PartitionedSearch. The runs of the permutations of other partitions are
+// then written in the directories of their owners (inbox files, named by
+// distance) and merged by them when the layer of that distance is finalized.
+class ExternalSearch {
+
+private:
+
+  // Permutation size
+  element n;
+
+  // Flag: only representatives of symmetry classes
+  bool symmetry;
+
+  // List of inversions and its maximum weight
+  inversion_list list;
+  weight maxWeight;
+
+  // Temporary directory
+  std::string directory;
+
+  // Number of permutations kept by the buffers of the generated permutations
+  // and by all file readers
+  size_t capacity;
+  size_t readerCapacity;
+
+  // Generated permutations of each distance (modulo maxWeight + 1): buffers
+  // in memory and run files
+  std::vector<std::vector<permutation_int> > buffers;
+  std::vector<std::vector<std::string> > runs;
+  size_t buffered;
+  __uint64_t nRuns;
+
+  // Number of permutations kept by the run files of each distance (modulo
+  // maxWeight + 1)
+  std::vector<__uint64_t> runSizes;
+
+  // Partition kept by this search: its index, the number of partitions, the
+  // smallest permutation of each one and the directory which keeps the
+  // directories of all partitions
+  int worker;
+  int workers;
+  std::vector<permutation_int> bounds;
+  std::string spool;
+
+  // Last finalized distance and largest generated distance
+  int current;
+  int horizon;
+
+  // Progress records (NULL if they are not wanted)
+  Progress *progress;
+
+  // Name of the file which keeps the layer of the given distance
+  std::string layerFile(const int distance) const {
+    return layerFileName(directory, distance);
+  }
+
+  // Distance of the generated permutations kept with the given index (the
+  // distances modulo maxWeight + 1 after the last finalized layer)
+  int pendingDistance(const int index) const {
+    int modulus = maxWeight + 1;
+    return current + 1 + ((index - current - 1) % modulus + modulus) % modulus;
+  }
+
+  // Writes the given permutations in a file
+  static void writeKeys(const std::string name, const permutation_int *keys, const size_t size) {
+    std::ofstream file(name, std::ios::out | std::ios::trunc | std::ios::binary);
+    file.write(reinterpret_cast<const char *>(keys), size * sizeof(permutation_int));
+    if (!file.good()) {
+      std::cerr << std::endl << "ERROR!!! Could not write file " << name << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  // Sorts the given permutations and removes duplicates
+  static void sortUnique(std::vector<permutation_int> &keys) {
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+  }
+
+  // Writes all buffers as run files. The permutations of other partitions
+  // are sent to their owners (the inbox files are renamed once written).
+  void spill() {
+    for (int w = 0; w <= maxWeight; ++w) {
+      if (buffers[w].empty()) continue;
+      sortUnique(buffers[w]);
+      std::vector<permutation_int>::iterator begin = buffers[w].begin(), end;
+      for (int t = 0; t < workers; ++t, begin = end) {
+	end = t + 1 < workers ? std::lower_bound(begin, buffers[w].end(), bounds[t + 1]) : buffers[w].end();
+	if (begin == end) continue;
+	std::string name = directory + "/run-" + std::to_string((long long int)nRuns++);
+	if (t == worker) {
+	  writeKeys(name, &*begin, end - begin);
+	  runs[w].push_back(name);
+	} else {
+	  std::string inbox = spool + "/worker-" + std::to_string((long long int)t);
+	  std::string sent = inbox + "/in-" + std::to_string((long long int)pendingDistance(w)) + "-" +
+	    std::to_string((long long int)worker) + "-" + std::to_string((long long int)nRuns);
+	  name = inbox + "/tmp-" + std::to_string((long long int)worker) + "-" + std::to_string((long long int)nRuns);
+	  writeKeys(name, &*begin, end - begin);
+	  if (std::rename(name.c_str(), sent.c_str()) != 0) {
+	    std::cerr << std::endl << "ERROR!!! Could not write file " << sent << std::endl << std::endl;
+	    exit(EXIT_FAILURE);
+	  }
+	}
+      }
+      runSizes[w] += buffers[w].size();
+      buffers[w].clear();
+      std::vector<permutation_int>().swap(buffers[w]);
+    }
+    buffered = 0;
+  }
+
+  // Keeps a permutation generated with the given distance
+  void generated(const permutation_int intPi, const int distance) {
+    if (buffered == capacity) spill();
+    buffers[distance % (maxWeight + 1)].push_back(intPi);
+    horizon = std::max(horizon, distance);
+    ++buffered;
+  }
+
+  // Returns the number of generated permutations not finalized yet
+  // (duplicates included)
+  __uint64_t frontier() const {
+    __uint64_t total = buffered;
+    for (int w = 0; w <= maxWeight; ++w)
+      total += runSizes[w];
+    return total;
+  }
+
+  // Returns true if there are generated permutations not finalized yet
+  bool hasPending() const {
+    if (buffered > 0) return true;
+    for (int w = 0; w <= maxWeight; ++w)
+      if (!runs[w].empty()) return true;
+    return false;
+  }
+
+  // Finalizes the layer of the given distance: merges its runs (and the
+  // inbox files sent by other partitions), removes the permutations of the
+  // previous layers and writes the layer file and the output records (if
+  // there is an output). Returns the number of permutations of the layer.
+  __uint64_t finalizeLayer(const int distance, RecordWriter *output) {
+
+    std::vector<permutation_int> &memory = buffers[distance % (maxWeight + 1)];
+    std::vector<std::string> &files = runs[distance % (maxWeight + 1)];
+    buffered -= memory.size();
+    sortUnique(memory);
+
+    if (workers > 1) {
+      std::string prefix = "in-" + std::to_string((long long int)distance) + "-";
+      DIR *inbox = opendir(directory.c_str());
+      if (inbox == NULL) {
+	std::cerr << std::endl << "ERROR!!! Could not read directory " << directory << std::endl << std::endl;
+	exit(EXIT_FAILURE);
+      }
+      for (struct dirent *entry = readdir(inbox); entry != NULL; entry = readdir(inbox))
+	if (std::string(entry->d_name).compare(0, prefix.size(), prefix) == 0)
+	  files.push_back(directory + "/" + entry->d_name);
+      closedir(inbox);
+    }
+
+    // Readers of the runs (merged with a heap) and of the previous layers
+    int first_previous = std::max(0, distance - 2 * maxWeight);
+    size_t length = std::max((size_t)MIN_READ_BUFFER,
+			     readerCapacity / (files.size() + (distance - first_previous) + 1));
+    std::vector<KeyReader*> readers;
+    for (size_t r = 0; r < files.size(); ++r)
+      readers.push_back(new KeyReader(files[r], length));
+    std::vector<KeyReader*> previous;
+    for (int d = first_previous; d < distance; ++d)
+      previous.push_back(new KeyReader(layerFile(d), length));
+
+    typedef std::pair<permutation_int, size_t> entry;
+    std::priority_queue<entry, std::vector<entry>, std::greater<entry> > heap;
+    for (size_t r = 0; r < readers.size(); ++r)
+      if (readers[r]->valid()) heap.push(entry(readers[r]->key(), r));
+
+    std::ofstream layer(layerFile(distance), std::ios::out | std::ios::trunc | std::ios::binary);
+    std::vector<permutation_int> layerBuffer;
+    layerBuffer.reserve(length);
+
+    __uint64_t count = 0;
+    size_t memoryIndex = 0;
+    bool first = true;
+    permutation_int last = 0;
+
+    while (memoryIndex < memory.size() || !heap.empty()) {
+
+      // Take the smallest permutation
+      permutation_int intPi;
+      if (heap.empty() || (memoryIndex < memory.size() && memory[memoryIndex] < heap.top().first)) {
+	intPi = memory[memoryIndex++];
+      } else {
+	size_t r = heap.top().second;
+	intPi = heap.top().first;
+	heap.pop();
+	readers[r]->next();
+	if (readers[r]->valid()) heap.push(entry(readers[r]->key(), r));
+      }
+      if (!first && intPi == last) continue;
+      first = false;
+      last = intPi;
+
+      // Verify if it belongs to a previous layer
+      bool found = false;
+      for (size_t p = 0; p < previous.size(); ++p) {
+	while (previous[p]->valid() && previous[p]->key() < intPi) previous[p]->next();
+	if (previous[p]->valid() && previous[p]->key() == intPi) found = true;
+      }
+      if (found) continue;
+
+      if (output) output->write(intPi, distance);
+      layerBuffer.push_back(intPi);
+      if (layerBuffer.size() == length) {
+	layer.write(reinterpret_cast<const char *>(layerBuffer.data()), layerBuffer.size() * sizeof(permutation_int));
+	layerBuffer.clear();
+      }
+      ++count;
+    }
+
+    layer.write(reinterpret_cast<const char *>(layerBuffer.data()), layerBuffer.size() * sizeof(permutation_int));
+    if (!layer.good()) {
+      std::cerr << std::endl << "ERROR!!! Could not write file " << layerFile(distance) << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    layer.close();
+    if (output) output->endLayer();
+
+    for (size_t r = 0; r < readers.size(); ++r) {
+      delete readers[r];
+      std::remove(files[r].c_str());
+    }
+    for (size_t p = 0; p < previous.size(); ++p)
+      delete previous[p];
+    files.clear();
+    runSizes[distance % (maxWeight + 1)] = 0;
+    memory.clear();
+    std::vector<permutation_int>().swap(memory);
+
+    // This layer is no longer needed to remove duplicates (the last layer is
+    // kept while it is expanded or read)
+    if (maxWeight > 0 && distance >= 2 * maxWeight)
+      std::remove(layerFile(distance - 2 * maxWeight).c_str());
+
+    current = distance;
+    return count;
+  }
+
+  // Generates the neighbours of all permutations of the given layer
+  void expandLayer(const int distance) {
+    KeyReader reader(layerFile(distance), readerCapacity);
+    __uint64_t expanded = 0;
+    for (; reader.valid(); reader.next()) {
+      if (progress && ++expanded == PROGRESS_STEP) {
+	progress->advance(expanded);
+	expanded = 0;
+      }
+      permutation_int intPi = reader.key();
+      for (inversion_list_it it = list.begin(); it != list.end(); ++it) {
+	permutation_int intSigma = applyInversionInt(n, (*it).i, (*it).j, intPi);
+	if (symmetry) {
+	  generated(canonical(n, intSigma), distance + (*it).w);
+	  intSigma = applyElementInversionInt(n, (*it).i, (*it).j, intPi);
+	  generated(canonical(n, intSigma), distance + (*it).w);
+	} else {
+	  generated(intSigma, distance + (*it).w);
+	}
+      }
+    }
+    if (progress) progress->advance(expanded);
+  }
+
+  // Removes the last layer files and the directory
+  void cleanUp() {
+    for (int d = std::max(0, current - 2 * maxWeight); d <= current; ++d)
+      std::remove(layerFile(d).c_str());
+    rmdir(directory.c_str());
+  }
+
+  // Returns the identity permutation (integer format)
+  permutation_int identity() const {
+    permutation_vector vectorPi = permutation_vector(n);
+    identityPermutation(n, vectorPi);
+    return vector_to_int(n, vectorPi);
+  }
+
+public:
+
+  // Constructor (the memory budget is given in bytes)
+  ExternalSearch(const element N, const __uint64_t budget, const std::string D, const bool S) {
+    n = N;
+    symmetry = S;
+    directory = D;
+    list = getPossibleInversions(SWI_LS, n, IS_SIGNED);
+    maxWeight = 0;
+    for (inversion_list_it it = list.begin(); it != list.end(); ++it)
+      maxWeight = std::max(maxWeight, (*it).w);
+    // Half of the budget for the generated permutations, half for the readers
+    capacity = std::max((__uint64_t)1, budget / 2 / sizeof(permutation_int));
+    readerCapacity = std::max((__uint64_t)MIN_READ_BUFFER, budget / 2 / sizeof(permutation_int));
+    buffers = std::vector<std::vector<permutation_int> >(maxWeight + 1);
+    runs = std::vector<std::vector<std::string> >(maxWeight + 1);
+    buffered = 0;
+    nRuns = 0;
+    runSizes = std::vector<__uint64_t>(maxWeight + 1, 0);
+    worker = 0;
+    workers = 1;
+    bounds = std::vector<permutation_int>(1, identity());
+    current = -1;
+    horizon = 0;
+    progress = NULL;
+  }
+
+  // Keeps only the partition of the given index (W partitions of consecutive
+  // ranks). The directories of all partitions are inside of the given one.
+  void setPartition(const int index, const int W, const std::string S) {
+    worker = index;
+    workers = W;
+    spool = S;
+    bounds.clear();
+    for (int t = 0; t < workers; ++t)
+      bounds.push_back(rank_to_int(n, numberOfPermutations(n) * t / workers));
+  }
+
+  // Reports the progress of the search in the given records (the pending
+  // permutations are the generated records, see frontier).
+  void setProgress(Progress *P) {
+    progress = P;
+    if (progress) progress->setPendingRecords();
+  }
+
+  // Does the real job.
+  void run(RecordWriter &output) {
+
+    if (mkdir(directory.c_str(), 0700) != 0) {
+      std::cerr << std::endl << "ERROR!!! Could not create directory " << directory << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+    }
+
+    // Start with the identity permutation
+    generated(identity(), 0);
+
+    for (int distance = 0; hasPending(); ++distance) {
+      __uint64_t size = finalizeLayer(distance, &output);
+      if (size == 0) continue;
+      if (progress) progress->startLayer(distance, size, frontier());
+      expandLayer(distance);
+      if (progress) progress->endLayer(frontier(), output.written());
+    }
+
+    // Clean-up the temporary directory
+    cleanUp();
+  }
+
+  // Returns the nonce of the search of the coordinator, or 0 if there is no
+  // search in the spool directory (or another one)
+  __uint64_t searchNonce() const {
+    __uint64_t search[PARTITION_SEARCH];
+    if (!readSpoolFile(spool + "/search", search, PARTITION_SEARCH)) return 0;
+    if (search[0] != (__uint64_t)n || search[1] != (__uint64_t)symmetry || search[2] != (__uint64_t)workers) {
+      std::cerr << std::endl << "ERROR!!! The coordinator of " << spool << " runs a different search.";
+      std::cerr << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    return search[3];
+  }
+
+  // Runs the search as a worker of a PartitionedSearch, through the files of
+  // the spool directory: the coordinator writes the description of the
+  // search (file search: size, symmetry flag, number of partitions and a
+  // nonce of the run) and a marker file for each command (see
+  // commandFileName), and the worker answers each one with a reply file (see
+  // replyFileName) once it is done. The replies start with the nonce,
+  // followed by the size of the layer and the number of pending permutations
+  // (PARTITION_FINALIZE) or the number of pending permutations and the
+  // largest generated distance (PARTITION_EXPAND), and by the peak resident
+  // set size of the worker (in KB). All permutations generated by an
+  // expansion are written (or sent) before the reply. Meanwhile, a thread
+  // writes the heartbeats of the worker, and the worker stops if the search
+  // of the coordinator disappears (failures) or is replaced.
+  void serve() {
+
+    // Wait for the coordinator
+    __uint64_t nonce;
+    while ((nonce = searchNonce()) == 0)
+      usleep(PARTITION_POLL);
+
+    // Heartbeats
+    std::mutex beatMutex;
+    std::condition_variable beatCondition;
+    bool stopping = false;
+    std::thread beats([&] {
+      std::unique_lock<std::mutex> lock(beatMutex);
+      __uint64_t beat[2] = { nonce, 0 };
+      do {
+	writeSpoolFile(heartbeatFileName(spool, worker), beat, 2);
+	++beat[1];
+      } while (!beatCondition.wait_for(lock, std::chrono::seconds(PARTITION_HEARTBEAT),
+				       [&] { return stopping; }));
+    });
+
+    // Start with the identity permutation, if it belongs to this partition
+    if (std::upper_bound(bounds.begin(), bounds.end(), identity()) - bounds.begin() - 1 == worker)
+      generated(identity(), 0);
+
+    int last = PARTITION_EXPAND, distance = -1;
+    while (true) {
+
+      // Wait for the next command: the finalization of the next layer, the
+      // expansion of the finalized one or the end of the search
+      int type = -1;
+      while (type < 0) {
+	if (spoolFileExists(commandFileName(spool, PARTITION_FINALIZE, distance + 1)))
+	  type = PARTITION_FINALIZE;
+	else if (last == PARTITION_FINALIZE && spoolFileExists(commandFileName(spool, PARTITION_EXPAND, distance)))
+	  type = PARTITION_EXPAND;
+	else if (spoolFileExists(commandFileName(spool, PARTITION_STOP, distance + 1)))
+	  type = PARTITION_STOP;
+	else if (searchNonce() != nonce) {
+	  std::cerr << std::endl << "ERROR!!! The search of " << spool << " was stopped." << std::endl << std::endl;
+	  exit(EXIT_FAILURE);
+	} else
+	  usleep(PARTITION_POLL);
+      }
+      if (type == PARTITION_STOP) break;
+      if (type == PARTITION_FINALIZE) ++distance;
+
+      __uint64_t reply[4];
+      reply[0] = nonce;
+      if (type == PARTITION_FINALIZE) {
+	reply[1] = finalizeLayer(distance, NULL);
+	reply[2] = frontier();
+      } else {
+	expandLayer(distance);
+	spill();
+	reply[1] = frontier();
+	reply[2] = horizon;
+      }
+      reply[3] = Progress::peakRSS();
+      writeSpoolFile(replyFileName(spool, type, distance, worker), reply, 4);
+      last = type;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(beatMutex);
+      stopping = true;
+    }
+    beatCondition.notify_all();
+    beats.join();
+
+    cleanUp();
+    writeSpoolFile(replyFileName(spool, PARTITION_STOP, distance + 1, worker), &nonce, 1);
+  }
+
+};
+
+#endif // __SEARCH_EXTERNAL__
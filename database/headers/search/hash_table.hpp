@@ -0,0 +1,182 @@
+/******************************************************************************/
+/*                                                                            */
+/*   This file is part of SWI-LS.                                             */
+/*                                                                            */
+/*   SWI-LS is free software: you can redistribute it and/or modify           */
+/*   it under the terms of the GNU General Public License as published by     */
+/*   the Free Software Foundation, either version 2 of the License, or        */
+/*   any later version.                                                       */
+/*                                                                            */
+/*   SWI-LS is distributed in the hope that it will be useful,                */
+/*   but WITHOUT ANY WARRANTY; without even the implied warranty of           */
+/*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            */
+/*   GNU General Public License for more details.                             */
+/*                                                                            */
+/*   You should have received a copy of the GNU General Public License        */
+/*   along with SWI-LS.  If not, see <http://www.gnu.org/licenses/>.          */
+/*                                                                            */
+/******************************************************************************/
+
+/* ************************************************************************** */
+/* Concurrent open-addressing hash table of permutations and their values     */
+/* ************************************************************************** */
+
+#ifndef __SEARCH_HASH_TABLE__
+#define __SEARCH_HASH_TABLE__
+
+#include <new>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <cinttypes>
+
+#include <linear/keys.hpp>
+
+// States of the slots of the hash table.
+#define SLOT_EMPTY 0
+#define SLOT_BUSY  1
+#define SLOT_FULL  2
+
+// Class FlatHashTable: Hash table of permutations (keys of 64 or 128 bits,
+// see linear/keys.hpp) and their values (by default, distances of one byte),
+// with linear probing over flat arrays (keys, states and values). Many
+// threads may insert permutations and lower values at the same time: a
+// thread claims an empty slot by moving its state from SLOT_EMPTY to
+// SLOT_BUSY, writes the key and then publishes it with SLOT_FULL, while the
+// other threads which reach a busy slot wait for it. Values are lowered with
+// atomic operations, as the distances of DenseSearch. The table is resized by
+// a single thread (grow), when no other thread is using it.
+template <typename Key, typename Value = __uint8_t>
+class FlatHashTable {
+
+private:
+
+  // Number of slots (a power of two) and the mask of the slot indexes
+  __uint64_t capacity;
+  __uint64_t mask;
+
+  // Number of permutations in the table
+  std::atomic<__uint64_t> count;
+
+  // Slots
+  Key* keys;
+  __uint8_t* states;
+  Value* values;
+
+  // Allocates and clears the slots
+  void allocate(const __uint64_t slots) {
+    capacity = slots;
+    mask = slots - 1;
+    keys = new (std::nothrow) Key[capacity];
+    states = new (std::nothrow) __uint8_t[capacity];
+    values = new (std::nothrow) Value[capacity];
+    if (keys == NULL || states == NULL || values == NULL) {
+      std::cerr << std::endl << "ERROR!!! Could not allocate a hash table of " << capacity;
+      std::cerr << " permutations." << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    memset(states, SLOT_EMPTY, capacity);
+  }
+
+  // Releases the slots
+  void release() {
+    delete[] keys;
+    delete[] states;
+    delete[] values;
+  }
+
+  // Returns the first slot of the given key
+  __uint64_t home(const Key key) const {
+    return KeyHash()(key) & mask;
+  }
+
+public:
+
+  // Value returned for the permutations which are not in the table
+  static constexpr Value MISSING = (Value)~(Value)0;
+
+  // Constructor (the number of slots is rounded up to a power of two)
+  FlatHashTable(const __uint64_t slots) : count(0) {
+    __uint64_t size = 1024;
+    while (size < slots) size <<= 1;
+    allocate(size);
+  }
+
+  // Destructor
+  ~FlatHashTable() {
+    release();
+  }
+
+  // Number of permutations and of slots
+  __uint64_t size() const { return count.load(); }
+  __uint64_t slots() const { return capacity; }
+
+  // Size of the slots, in bytes
+  __uint64_t bytes() const { return capacity * (sizeof(Key) + sizeof(Value) + 1); }
+
+  // Inserts the permutation with the given value or lowers its value.
+  // Returns false if the given value is not lower than the one in the table.
+  bool insert(const Key key, const Value value) {
+    __uint64_t index = home(key);
+    while (true) {
+      __uint8_t state = __atomic_load_n(&states[index], __ATOMIC_ACQUIRE);
+      if (state == SLOT_EMPTY) {
+	if (__atomic_compare_exchange_n(&states[index], &state, (__uint8_t)SLOT_BUSY, false,
+					__ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+	  keys[index] = key;
+	  values[index] = value;
+	  __atomic_store_n(&states[index], (__uint8_t)SLOT_FULL, __ATOMIC_RELEASE);
+	  count.fetch_add(1, std::memory_order_relaxed);
+	  return true;
+	}
+	continue;
+      }
+      if (state == SLOT_BUSY) continue;
+      if (keys[index] == key) {
+	Value old = __atomic_load_n(&values[index], __ATOMIC_RELAXED);
+	while (old > value) {
+	  if (__atomic_compare_exchange_n(&values[index], &old, value, true,
+					  __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+	    return true;
+	}
+	return false;
+      }
+      index = (index + 1) & mask;
+    }
+  }
+
+  // Returns the value of the given permutation (MISSING if it is not in the
+  // table)
+  Value find(const Key key) const {
+    for (__uint64_t index = home(key); ; index = (index + 1) & mask) {
+      __uint8_t state = __atomic_load_n(&states[index], __ATOMIC_ACQUIRE);
+      if (state == SLOT_EMPTY) return MISSING;
+      if (state == SLOT_FULL && keys[index] == key)
+	return __atomic_load_n(&values[index], __ATOMIC_RELAXED);
+    }
+  }
+
+  // Doubles the number of slots (single thread)
+  void grow() {
+    __uint64_t oldCapacity = capacity;
+    Key* oldKeys = keys;
+    __uint8_t* oldStates = states;
+    Value* oldValues = values;
+    allocate(capacity << 1);
+    for (__uint64_t i = 0; i < oldCapacity; ++i) {
+      if (oldStates[i] != SLOT_FULL) continue;
+      __uint64_t index = home(oldKeys[i]);
+      while (states[index] != SLOT_EMPTY) index = (index + 1) & mask;
+      keys[index] = oldKeys[i];
+      values[index] = oldValues[i];
+      states[index] = SLOT_FULL;
+    }
+    delete[] oldKeys;
+    delete[] oldStates;
+    delete[] oldValues;
+  }
+
+};
+
+#endif // __SEARCH_HASH_TABLE__
@@ -0,0 +1,202 @@
+/******************************************************************************/
+/*                                                                            */
+/*   This file is part of SWI-LS.                                             */
+/*                                                                            */
+/*   SWI-LS is free software: you can redistribute it and/or modify           */
+/*   it under the terms of the GNU General Public License as published by     */
+/*   the Free Software Foundation, either version 2 of the License, or        */
+/*   any later version.                                                       */
+/*                                                                            */
+/*   SWI-LS is distributed in the hope that it will be useful,                */
+/*   but WITHOUT ANY WARRANTY; without even the implied warranty of           */
+/*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            */
+/*   GNU General Public License for more details.                             */
+/*                                                                            */
+/*   You should have received a copy of the GNU General Public License        */
+/*   along with SWI-LS.  If not, see <http://www.gnu.org/licenses/>.          */
+/*                                                                            */
+/******************************************************************************/
+
+/* ************************************************************************** */
+/* Packed (modular) tentative distances of all permutations                   */
+/* ************************************************************************** */
+
+#ifndef __SEARCH_MODULAR__
+#define __SEARCH_MODULAR__
+
+#include <new>
+#include <cstdlib>
+#include <iostream>
+#include <cinttypes>
+
+// Value returned by DistanceArray::relax for the permutations reached for the
+// first time.
+#define FIRST_REACH 255
+
+// Class DistanceArray: Distances of all permutations (indexed by rank) used by
+// DenseSearch, kept as codes of a few bits packed in 64-bit words.
+// In the modular encoding, the codes of the permutations not finalized yet
+// keep their tentative distance modulo maxWeight + 1 (a reached permutation
+// is at most maxWeight away from the layer being expanded, so the residue
+// identifies its distance), and two more codes mark the unreached and the
+// finalized permutations: 3 bits per permutation up to maxWeight 5 and 4 bits
+// up to maxWeight 13. The distances of the finalized permutations are lost,
+// so each layer must be written when it is expanded and finalized (finalize)
+// before the next one. In the absolute encoding, each code keeps the
+// distance itself in 8 bits (as needed by the compact databases and the
+// policy tables) and finalize does nothing.
+// Codes are lowered with atomic operations on their words, so many threads
+// may relax distances at the same time.
+class DistanceArray {
+
+private:
+
+  // Number of permutations
+  __uint64_t states;
+
+  // Flag: modular encoding
+  bool modular;
+
+  // Bits per code, codes per word and mask of a code
+  int bits;
+  int perWord;
+  __uint64_t mask;
+
+  // Modulus of the distances and maximum weight of an inversion
+  int modulus;
+  int maxWeight;
+
+  // Codes of the unreached and finalized permutations
+  int unreachedCode;
+  int finalizedCode;
+
+  // Codes
+  __uint64_t words;
+  __uint64_t* data;
+
+public:
+
+  // Constructor. The distances of all permutations are unreached.
+  DistanceArray(const __uint64_t S, const int W, const bool M) {
+    states = S;
+    maxWeight = W;
+    modular = M;
+    if (modular) {
+      modulus = maxWeight + 1;
+      bits = modulus + 2 <= 8 ? 3 : 4;
+      if (modulus + 2 > 16) {
+	std::cerr << std::endl << "ERROR!!! The inversion weights are too large for";
+	std::cerr << " the modular encoding." << std::endl << std::endl;
+	exit(EXIT_FAILURE);
+      }
+    } else {
+      modulus = 255;
+      bits = 8;
+    }
+    perWord = 64 / bits;
+    mask = ((__uint64_t)1 << bits) - 1;
+    unreachedCode = mask;
+    finalizedCode = modular ? mask - 1 : mask;
+    words = (states + perWord - 1) / perWord;
+    data = new (std::nothrow) __uint64_t[words];
+    if (data == NULL) {
+      std::cerr << std::endl << "ERROR!!! Could not allocate " << words * sizeof(__uint64_t);
+      std::cerr << " bytes for the distances." << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    __uint64_t full = 0;
+    for (int c = 0; c < perWord; ++c)
+      full = (full << bits) | mask;
+    for (__uint64_t w = 0; w < words; ++w)
+      data[w] = full;
+  }
+
+  // Destructor
+  ~DistanceArray() {
+    delete[] data;
+  }
+
+  // Returns true for the modular encoding
+  bool isModular() const { return modular; }
+
+  // Bits per permutation
+  int codeBits() const { return bits; }
+
+  // Raw codes (checkpoints)
+  char* raw() { return reinterpret_cast<char *>(data); }
+  const char* raw() const { return reinterpret_cast<const char *>(data); }
+  __uint64_t size() const { return words * sizeof(__uint64_t); }
+
+  // Returns the code of the permutation with the given rank
+  int code(const __uint64_t rank) const {
+    __uint64_t word = __atomic_load_n(&data[rank / perWord], __ATOMIC_RELAXED);
+    return (word >> ((rank % perWord) * bits)) & mask;
+  }
+
+  // Returns the code of the permutations of the given (current) distance
+  int layerCode(const int distance) const {
+    return distance % modulus;
+  }
+
+  // Returns true if the permutation with the given rank was reached
+  bool reached(const __uint64_t rank) const {
+    return code(rank) != unreachedCode;
+  }
+
+  // Returns the distance of the permutation with the given rank (absolute
+  // encoding only)
+  int distance(const __uint64_t rank) const {
+    return code(rank);
+  }
+
+  // Sets the distance of the permutation with the given rank (single thread)
+  void set(const __uint64_t rank, const int distance) {
+    int shift = (rank % perWord) * bits;
+    __uint64_t &word = data[rank / perWord];
+    word = (word & ~(mask << shift)) | ((__uint64_t)(distance % modulus) << shift);
+  }
+
+  // Lowers the distance of the given rank to newDistance, while the layer of
+  // the given distance is expanded. Returns FIRST_REACH for permutations not
+  // reached before, the old code (the old distance modulo maxWeight + 1) if
+  // it was lowered or -1 if the given distance is not better.
+  int relax(const __uint64_t rank, const int current, const int newDistance) {
+    int shift = (rank % perWord) * bits;
+    __uint64_t *word = &data[rank / perWord];
+    __uint64_t oldWord = __atomic_load_n(word, __ATOMIC_RELAXED);
+    while (true) {
+      int old = (oldWord >> shift) & mask;
+      if (old != unreachedCode) {
+	if (old == finalizedCode && modular) return -1;
+	// Permutations which are not pending are in the current or in
+	// previous layers
+	int offset = (old - current % modulus + modulus) % modulus;
+	if (offset == 0 || offset > maxWeight || current + offset <= newDistance) return -1;
+      }
+      __uint64_t newWord = (oldWord & ~(mask << shift)) | ((__uint64_t)(newDistance % modulus) << shift);
+      if (__atomic_compare_exchange_n(word, &oldWord, newWord, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+	return old == unreachedCode ? FIRST_REACH : old;
+    }
+  }
+
+  // Finalizes the permutations of the given (expanded) distance kept by the
+  // words in the interval [begin, end) (modular encoding only)
+  void finalize(const __uint64_t begin, const __uint64_t end, const int distance) {
+    if (!modular) return;
+    __uint64_t layer = distance % modulus;
+    for (__uint64_t w = begin; w < end; ++w) {
+      __uint64_t word = data[w];
+      for (int c = 0; c < perWord; ++c) {
+	if (((word >> (c * bits)) & mask) == layer)
+	  word = (word & ~(mask << (c * bits))) | ((__uint64_t)finalizedCode << (c * bits));
+      }
+      data[w] = word;
+    }
+  }
+
+  // Number of words
+  __uint64_t wordCount() const { return words; }
+
+};
+
+#endif // __SEARCH_MODULAR__
@@ -0,0 +1,332 @@
+/******************************************************************************/
+/*                                                                            */
+/*   This file is part of SWI-LS.                                             */
+/*                                                                            */
+/*   SWI-LS is free software: you can redistribute it and/or modify           */
+/*   it under the terms of the GNU General Public License as published by     */
+/*   the Free Software Foundation, either version 2 of the License, or        */
+/*   any later version.                                                       */
+/*                                                                            */
+/*   SWI-LS is distributed in the hope that it will be useful,                */
+/*   but WITHOUT ANY WARRANTY; without even the implied warranty of           */
+/*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            */
+/*   GNU General Public License for more details.                             */
+/*                                                                            */
+/*   You should have received a copy of the GNU General Public License        */
+/*   along with SWI-LS.  If not, see <http://www.gnu.org/licenses/>.          */
+/*                                                                            */
+/******************************************************************************/
+
+/* ************************************************************************** */
+/* Dijkstra over all permutations by many processes (partitions of the ranks) */
+/* ************************************************************************** */
+
+#ifndef __SEARCH_PARTITIONED__
+#define __SEARCH_PARTITIONED__
+
+// IMPORTANT: One of the headers linear/signed.hpp or linear/unsigned.hpp must
+// be included before this one.
+
+#include <chrono>
+#include <cerrno>
+#include <random>
+#include <string>
+#include <vector>
+#include <csignal>
+#include <iostream>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include <search/external.hpp>
+
+// Default memory budget of each worker, in MB.
+#define PARTITION_BUDGET 256
+
+// Time without heartbeats after which a worker started by hand is considered
+// stopped, in seconds.
+#define PARTITION_TIMEOUT 60
+
+// Class PartitionedSearch: It generates the same database as ExternalSearch
+// with many worker processes. Each worker is an ExternalSearch which owns a
+// range of consecutive ranks (a partition) and keeps its files in its own
+// directory, inside of a spool directory which may be shared by many
+// machines. The workers send the permutations generated for other partitions
+// through inbox files (see ExternalSearch::spill), and the coordinator (this
+// process) advances the layers in lockstep through marker and reply files of
+// the spool directory (see ExternalSearch::serve): all workers finalize the
+// layer of distance d and, once the last one replied, all of them expand it.
+// The workers are started by the coordinator (fork) or by hand, on any
+// machine which shares the spool directory (see serve). The coordinator
+// detects the failures of the workers by their processes or, for the workers
+// started by hand, by their heartbeats, and then removes the files of the
+// search from the spool directory. Since the ranks of a
+// partition are smaller than the ranks of the next one, the output is the
+// concatenation of the layer files of the partitions.
+class PartitionedSearch {
+
+private:
+
+  // Permutation size
+  element n;
+
+  // Flag: only representatives of symmetry classes
+  bool symmetry;
+
+  // Number of workers and memory budget of each one (in bytes)
+  int workers;
+  __uint64_t budget;
+
+  // Spool directory (directories of the partitions and files of the commands)
+  std::string directory;
+
+  // Flag: the workers are started by this process
+  bool launch;
+
+  // Processes of the workers started by this process
+  std::vector<pid_t> pids;
+
+  // Nonce of this run, echoed by the workers in their replies
+  __uint64_t nonce;
+
+  // Last heartbeat of each worker and the time it was seen
+  std::vector<__uint64_t> beats;
+  std::vector<std::chrono::steady_clock::time_point> seen;
+
+  // Progress records (NULL if they are not wanted)
+  Progress *progress;
+
+  // Directory of the given partition
+  std::string workerDirectory(const int worker) const {
+    return directory + "/worker-" + std::to_string((long long int)worker);
+  }
+
+  // Removes the files of the given directory whose names start with one of
+  // the given prefixes (all files if there are none)
+  static void removeFiles(const std::string &name, const std::vector<std::string> &prefixes) {
+    DIR *dir = opendir(name.c_str());
+    if (dir == NULL) return;
+    for (struct dirent *entry = readdir(dir); entry != NULL; entry = readdir(dir)) {
+      std::string file = entry->d_name;
+      bool remove = prefixes.empty() && file.compare(".") != 0 && file.compare("..") != 0;
+      for (size_t p = 0; p < prefixes.size(); ++p)
+	remove = remove || file.compare(0, prefixes[p].size(), prefixes[p]) == 0;
+      if (remove) std::remove((name + "/" + file).c_str());
+    }
+    closedir(dir);
+  }
+
+  // Stops all workers after a failure and removes the files of the search
+  // (the workers started by hand stop once the file search is removed)
+  void fail(const int worker, const std::string reason) {
+    std::cerr << std::endl << "ERROR!!! The worker " << worker << " " << reason << "." << std::endl << std::endl;
+    for (size_t w = 0; w < pids.size(); ++w)
+      kill(pids[w], SIGTERM);
+    for (size_t w = 0; w < pids.size(); ++w)
+      waitpid(pids[w], NULL, 0);
+    std::vector<std::string> prefixes = { "search", "finalize-", "expand-", "stop-", "alive-" };
+    removeFiles(directory, prefixes);
+    for (int w = 0; w < workers; ++w) {
+      removeFiles(workerDirectory(w), std::vector<std::string>());
+      rmdir(workerDirectory(w).c_str());
+    }
+    rmdir(directory.c_str());
+    exit(EXIT_FAILURE);
+  }
+
+  // Checks whether the given worker is alive: its process (workers started
+  // by this process) or its heartbeats (workers started by hand, once they
+  // joined the search)
+  void check(const int worker) {
+    if (launch) {
+      int status;
+      if (waitpid(pids[worker], &status, WNOHANG) != 0) fail(worker, "stopped");
+      return;
+    }
+    __uint64_t beat[2];
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if (readSpoolFile(heartbeatFileName(directory, worker), beat, 2) && beat[0] == nonce && beat[1] != beats[worker]) {
+      beats[worker] = beat[1];
+      seen[worker] = now;
+    } else if (beats[worker] != (__uint64_t)-1 &&
+	       now - seen[worker] > std::chrono::seconds(PARTITION_TIMEOUT)) {
+      fail(worker, "stopped answering");
+    }
+  }
+
+  // Creates the processes of the workers
+  void start() {
+    std::cout.flush();
+    std::cerr.flush();
+    for (int w = 0; w < workers; ++w) {
+      pid_t pid = fork();
+      if (pid < 0) {
+	std::cerr << std::endl << "ERROR!!! Could not create the process of worker " << w << "." << std::endl << std::endl;
+	exit(EXIT_FAILURE);
+      }
+      if (pid == 0) {
+	serve(w);
+	_exit(EXIT_SUCCESS);
+      }
+      pids.push_back(pid);
+    }
+  }
+
+  // Sends a command to all workers and returns their replies (count values
+  // each one)
+  std::vector<std::vector<__uint64_t> > broadcast(const int type, const int distance, const int count) {
+    std::string command = commandFileName(directory, type, distance);
+    writeSpoolFile(command, NULL, 0);
+    std::vector<std::vector<__uint64_t> > toReturn(workers, std::vector<__uint64_t>(count));
+    for (int w = 0; w < workers; ++w) {
+      std::string reply = replyFileName(directory, type, distance, w);
+      std::vector<__uint64_t> values(count + 1);
+      while (!readSpoolFile(reply, values.data(), count + 1)) {
+	check(w);
+	usleep(PARTITION_POLL);
+      }
+      if (values[0] != nonce) fail(w, "replied for another search");
+      std::copy(values.begin() + 1, values.end(), toReturn[w].begin());
+      std::remove(reply.c_str());
+    }
+    std::remove(command.c_str());
+    return toReturn;
+  }
+
+  // Reports the sum of the peak resident set sizes of the workers, given by
+  // the last value of their replies
+  void reportRSS(const std::vector<std::vector<__uint64_t> > &replies) {
+    long rss = 0;
+    for (int w = 0; w < workers; ++w)
+      rss += replies[w].back();
+    progress->setWorkersRSS(rss);
+  }
+
+  // Stops the workers and waits for them
+  void stop(const int distance) {
+    broadcast(PARTITION_STOP, distance, 0);
+    for (size_t w = 0; w < pids.size(); ++w) {
+      int status;
+      if (waitpid(pids[w], &status, 0) != pids[w] || !WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS)
+	fail(w, "stopped");
+    }
+    for (int w = 0; w < workers; ++w)
+      std::remove(heartbeatFileName(directory, w).c_str());
+    std::remove((directory + "/search").c_str());
+  }
+
+public:
+
+  // Constructor (the memory budget of each worker is given in bytes)
+  PartitionedSearch(const element N, const int W, const __uint64_t B, const std::string D, const bool S) {
+    n = N;
+    symmetry = S;
+    workers = W;
+    budget = B;
+    directory = D;
+    launch = true;
+    nonce = 0;
+    progress = NULL;
+  }
+
+  // Sets whether the workers are started by this process (default) or by
+  // hand (see serve). In the latter case, the spool directory may already
+  // exist.
+  void setLaunch(const bool L) {
+    launch = L;
+  }
+
+  // Reports the progress of the search in the given records (the pending
+  // permutations are the generated records, see ExternalSearch::frontier).
+  void setProgress(Progress *P) {
+    progress = P;
+    if (progress) progress->setPendingRecords();
+  }
+
+  // Runs the given worker against the spool directory, until the coordinator
+  // stops the search.
+  void serve(const int worker) {
+    ExternalSearch search(n, budget, workerDirectory(worker), symmetry);
+    search.setPartition(worker, workers, directory);
+    search.serve();
+  }
+
+  // Does the real job.
+  void run(RecordWriter &output) {
+
+    if (mkdir(directory.c_str(), 0700) != 0 && (launch || errno != EEXIST)) {
+      std::cerr << std::endl << "ERROR!!! Could not create directory " << directory << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    if (spoolFileExists(directory + "/search")) {
+      std::cerr << std::endl << "ERROR!!! The directory " << directory << " keeps another search (remove it";
+      std::cerr << " if that search is not running)." << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    for (int w = 0; w < workers; ++w) {
+      if (mkdir(workerDirectory(w).c_str(), 0700) != 0) {
+	std::cerr << std::endl << "ERROR!!! Could not create directory " << workerDirectory(w) << std::endl << std::endl;
+	exit(EXIT_FAILURE);
+      }
+    }
+
+    // Description of the search, checked by the workers, with a nonce of
+    // this run (never 0)
+    std::random_device device;
+    do {
+      nonce = ((__uint64_t)device() << 32) ^ device() ^ (__uint64_t)getpid();
+    } while (nonce == 0);
+    beats.assign(workers, (__uint64_t)-1);
+    seen.assign(workers, std::chrono::steady_clock::now());
+    __uint64_t search[PARTITION_SEARCH] = { (__uint64_t)n, (__uint64_t)symmetry, (__uint64_t)workers, nonce };
+    writeSpoolFile(directory + "/search", search, PARTITION_SEARCH);
+
+    if (launch) start();
+
+    size_t length = std::max((__uint64_t)MIN_READ_BUFFER, budget / 2 / sizeof(permutation_int));
+    __uint64_t horizon = 0;
+    int distance = 0;
+    for (; distance <= (int)horizon; ++distance) {
+
+      __uint64_t size = 0, frontier = 0;
+      std::vector<std::vector<__uint64_t> > finalized = broadcast(PARTITION_FINALIZE, distance, 3);
+      for (int w = 0; w < workers; ++w) {
+	size += finalized[w][0];
+	frontier += finalized[w][1];
+      }
+
+      // The layer files of the partitions are kept until the layer of
+      // distance + 2 maxWeight is finalized
+      for (int w = 0; w < workers; ++w) {
+	KeyReader reader(layerFileName(workerDirectory(w), distance), length);
+	for (; reader.valid(); reader.next())
+	  output.write(reader.key(), distance);
+      }
+      output.endLayer();
+      if (size == 0) continue;
+
+      if (progress) {
+	reportRSS(finalized);
+	progress->startLayer(distance, size, frontier);
+      }
+      frontier = 0;
+      std::vector<std::vector<__uint64_t> > expanded = broadcast(PARTITION_EXPAND, distance, 3);
+      for (int w = 0; w < workers; ++w) {
+	frontier += expanded[w][0];
+	horizon = std::max(horizon, expanded[w][1]);
+      }
+      if (progress) {
+	reportRSS(expanded);
+	progress->advance(size);
+	progress->endLayer(frontier, output.written());
+      }
+    }
+
+    stop(distance);
+    rmdir(directory.c_str());
+  }
+
+};
+
+#endif // __SEARCH_PARTITIONED__
@@ -0,0 +1,243 @@
+/******************************************************************************/
+/*                                                                            */
+/*   This file is part of SWI-LS.                                             */
+/*                                                                            */
+/*   SWI-LS is free software: you can redistribute it and/or modify           */
+/*   it under the terms of the GNU General Public License as published by     */
+/*   the Free Software Foundation, either version 2 of the License, or        */
+/*   any later version.                                                       */
+/*                                                                            */
+/*   SWI-LS is distributed in the hope that it will be useful,                */
+/*   but WITHOUT ANY WARRANTY; without even the implied warranty of           */
+/*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            */
+/*   GNU General Public License for more details.                             */
+/*                                                                            */
+/*   You should have received a copy of the GNU General Public License        */
+/*   along with SWI-LS.  If not, see <http://www.gnu.org/licenses/>.          */
+/*                                                                            */
+/******************************************************************************/
+
+/* ************************************************************************** */
+/* Progress records (JSON lines) of the generation of the databases           */
+/* ************************************************************************** */
+
+#ifndef __SEARCH_PROGRESS__
+#define __SEARCH_PROGRESS__
+
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iostream>
+#include <cinttypes>
+#include <condition_variable>
+#include <sys/resource.h>
+
+// Number of expanded permutations counted at once by the searches which do
+// not work by chunks.
+#define PROGRESS_STEP 65536
+
+// Class Progress: It writes one JSON object per line with the state of a
+// search, in the standard error or in a file:
+//   {"event":"layer", ...}     when a layer is expanded;
+//   {"event":"progress", ...}  periodically, while a layer is expanded (by a
+//                              thread which wakes up at the given interval);
+//   {"event":"summary", ...}   at the end, with the number of permutations of
+//                              each distance (histogram) and the diameter.
+// The layer and progress records have the distance of the layer, its number
+// of permutations (states), how many of them were expanded, the number of
+// permutations waiting in the following layers (frontier), the expansion
+// rate (states per second), the size of the output, the elapsed time (in
+// seconds) and the peak resident set size (in KB). The searches call
+// startLayer, advance (from any thread) and endLayer.
+//
+// The searches on disk (ExternalSearch and PartitionedSearch) only know the
+// number of generated records of the following layers, duplicates included,
+// which may exceed the number of permutations: they call setPendingRecords
+// and the records have pending_records instead of frontier. The peak
+// resident set size of a PartitionedSearch is the sum of the peaks of the
+// coordinator and of the workers (see setWorkersRSS).
+class Progress {
+
+private:
+
+  // Output (the standard error if no file is given)
+  std::ofstream file;
+  std::ostream *out;
+  std::mutex outMutex;
+
+  // Interval between the periodic records (0 if there are none)
+  std::chrono::seconds interval;
+
+  // Start of the search and of the current layer
+  std::chrono::steady_clock::time_point start;
+  std::chrono::steady_clock::time_point layerStart;
+
+  // State of the current layer
+  std::atomic<int> distance;
+  std::atomic<__uint64_t> states;
+  std::atomic<__uint64_t> expanded;
+  std::atomic<__uint64_t> frontier;
+  std::atomic<__uint64_t> bytes;
+
+  // Name of the field of the pending permutations (frontier or
+  // pending_records)
+  const char *pendingName;
+
+  // Peak resident set size of the other processes of the search, in KB
+  std::atomic<long> workersRSS;
+
+  // Number of permutations of each distance
+  std::vector<__uint64_t> histogram;
+
+  // Periodic records
+  std::thread reporter;
+  std::mutex stopMutex;
+  std::condition_variable stopCondition;
+  bool stopping;
+
+  // Returns the number of seconds since the given time
+  static double seconds(const std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - since).count();
+  }
+
+  // Writes a layer or progress record
+  void record(const char *event) {
+    std::lock_guard<std::mutex> lock(outMutex);
+    double layerTime = seconds(layerStart);
+    __uint64_t done = expanded.load();
+    *out << "{\"event\":\"" << event << "\",\"distance\":" << distance.load();
+    *out << ",\"states\":" << states.load() << ",\"expanded\":" << done;
+    *out << ",\"" << pendingName << "\":" << frontier.load();
+    *out << ",\"states_per_second\":" << (__uint64_t)(layerTime > 0 ? done / layerTime : 0);
+    *out << ",\"bytes_written\":" << bytes.load() << ",\"elapsed\":" << seconds(start);
+    *out << ",\"peak_rss_kb\":" << peakRSS() + workersRSS.load() << "}" << std::endl;
+  }
+
+  // Writes the periodic records until the search ends
+  void report() {
+    std::unique_lock<std::mutex> lock(stopMutex);
+    while (!stopCondition.wait_for(lock, interval, [this] { return stopping; }))
+      record("progress");
+  }
+
+public:
+
+  // Returns the peak resident set size of this process, in KB
+  static long peakRSS() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+    return usage.ru_maxrss;
+  }
+
+  // Constructor. The records are written in the given file ("-" for the
+  // standard error), and also every interval (in seconds, if it is not zero)
+  // while a layer is expanded.
+  Progress(const std::string name, const int I) {
+    out = &std::cerr;
+    if (name.compare("-") != 0) {
+      file.open(name, std::ios::out | std::ios::trunc);
+      if (!file.is_open()) {
+	std::cerr << std::endl << "ERROR!!! Could not open file " << name << std::endl << std::endl;
+	exit(EXIT_FAILURE);
+      }
+      out = &file;
+    }
+    interval = std::chrono::seconds(I);
+    start = std::chrono::steady_clock::now();
+    layerStart = start;
+    distance = 0;
+    states = 0;
+    expanded = 0;
+    frontier = 0;
+    bytes = 0;
+    pendingName = "frontier";
+    workersRSS = 0;
+    stopping = false;
+    if (I > 0)
+      reporter = std::thread(&Progress::report, this);
+  }
+
+  // Destructor
+  ~Progress() {
+    {
+      std::lock_guard<std::mutex> lock(stopMutex);
+      stopping = true;
+    }
+    stopCondition.notify_all();
+    if (reporter.joinable()) reporter.join();
+  }
+
+  // The pending permutations given by the search are generated records,
+  // duplicates included
+  void setPendingRecords() {
+    pendingName = "pending_records";
+  }
+
+  // Keeps the sum of the peak resident set sizes of the workers (in KB), added
+  // to the one of this process
+  void setWorkersRSS(const long kb) {
+    workersRSS = kb;
+  }
+
+  // Counts permutations of the given distance which were not reported as a
+  // layer (layers generated before a checkpoint)
+  void count(const int d, const __uint64_t size) {
+    if ((int)histogram.size() <= d) histogram.resize(d + 1, 0);
+    histogram[d] += size;
+  }
+
+  // A layer with the given number of permutations starts to be expanded
+  // (frontier: number of permutations of the following layers)
+  void startLayer(const int d, const __uint64_t size, const __uint64_t pending) {
+    count(d, size);
+    std::lock_guard<std::mutex> lock(outMutex);
+    layerStart = std::chrono::steady_clock::now();
+    distance = d;
+    states = size;
+    expanded = 0;
+    frontier = pending;
+  }
+
+  // The given number of permutations of the layer were expanded
+  void advance(const __uint64_t size) {
+    expanded.fetch_add(size, std::memory_order_relaxed);
+  }
+
+  // The layer was expanded (output: size of the output written so far)
+  void endLayer(const __uint64_t pending, const __uint64_t output) {
+    frontier = pending;
+    bytes = output;
+    record("layer");
+  }
+
+  // Writes the summary (output: final size of the output)
+  void finish(const __uint64_t output) {
+    {
+      std::lock_guard<std::mutex> lock(stopMutex);
+      stopping = true;
+    }
+    stopCondition.notify_all();
+    if (reporter.joinable()) reporter.join();
+    bytes = output;
+    __uint64_t total = 0;
+    int diameter = -1;
+    for (size_t d = 0; d < histogram.size(); ++d) {
+      total += histogram[d];
+      if (histogram[d] > 0) diameter = d;
+    }
+    std::lock_guard<std::mutex> lock(outMutex);
+    *out << "{\"event\":\"summary\",\"states\":" << total << ",\"diameter\":" << diameter;
+    *out << ",\"histogram\":[";
+    for (int d = 0; d <= diameter; ++d)
+      *out << (d > 0 ? "," : "") << histogram[d];
+    *out << "],\"bytes_written\":" << bytes.load() << ",\"elapsed\":" << seconds(start);
+    *out << ",\"peak_rss_kb\":" << peakRSS() + workersRSS.load() << "}" << std::endl;
+  }
+
+};
+
+#endif // __SEARCH_PROGRESS__
@@ -0,0 +1,265 @@
+/******************************************************************************/
+/*                                                                            */
+/*   This file is part of SWI-LS.                                             */
+/*                                                                            */
+/*   SWI-LS is free software: you can redistribute it and/or modify           */
+/*   it under the terms of the GNU General Public License as published by     */
+/*   the Free Software Foundation, either version 2 of the License, or        */
+/*   any later version.                                                       */
+/*                                                                            */
+/*   SWI-LS is distributed in the hope that it will be useful,                */
+/*   but WITHOUT ANY WARRANTY; without even the implied warranty of           */
+/*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            */
+/*   GNU General Public License for more details.                             */
+/*                                                                            */
+/*   You should have received a copy of the GNU General Public License        */
+/*   along with SWI-LS.  If not, see <http://www.gnu.org/licenses/>.          */
+/*                                                                            */
+/******************************************************************************/
+
+/* ************************************************************************** */
+/* Output of (permutation, distance) records of the databases                 */
+/* ************************************************************************** */
+
+#ifndef __SEARCH_RECORDS__
+#define __SEARCH_RECORDS__
+
+// IMPORTANT: One of the headers linear/signed.hpp or linear/unsigned.hpp must
+// be included before this one.
+
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <cinttypes>
+#include <unistd.h>
+
+#include <format/text.hpp>
+#include <format/database.hpp>
+
+#define BUFFER_SIZE 64000
+
+// Class RecordWriter: It writes the records of a database file, either in text
+// format (one permutation and its distance per line, see format/text.hpp) or
+// in binary format (each record is a pair of words: permutation and distance,
+// after the header described in format/database.hpp). The header is written
+// first with no records and rewritten when the file is closed and whenever the
+// position of the output is requested (checkpoints), so it always describes
+// the records written up to that point. The records may also be written to the
+// standard output (file name DATABASE_STDIO), with the header of the streams,
+// and each layer is written once it is complete (endLayer), so the next
+// program of a pipeline can process it while the next layer is generated.
+class RecordWriter {
+
+private:
+
+  // Permutation size
+  element n;
+
+  // Output format
+  bool binary;
+
+  // Header (binary format)
+  DatabaseHeader header;
+
+  // Output file, or the standard output
+  std::ofstream outfile;
+  std::ostream *stream;
+  bool streamed;
+  bool open;
+
+  // Number of bytes written to the output
+  __uint64_t flushed;
+
+  // Buffer of the text records
+  TextBuffer* text;
+
+  // Buffers (binary format)
+  int buffer_index;
+  __uint16_t* buffer16;
+  __uint32_t* buffer32;
+  __uint64_t* buffer64;
+
+  // Writes the content of the buffer
+  void flushBuffer() {
+    if (text) {
+      flushed += text->size();
+      text->write(*stream);
+    }
+    if (buffer16) stream->write(reinterpret_cast<const char *>(buffer16), buffer_index * sizeof(__uint16_t));
+    if (buffer32) stream->write(reinterpret_cast<const char *>(buffer32), buffer_index * sizeof(__uint32_t));
+    if (buffer64) stream->write(reinterpret_cast<const char *>(buffer64), buffer_index * sizeof(__uint64_t));
+    buffer_index = 0;
+  }
+
+  // Returns the size of the records written so far (binary format)
+  __uint64_t end() const {
+    return sizeof(header) + header.count * header.wordBits / 4;
+  }
+
+  // Rewrites the header (binary format), once the buffer was written
+  void writeHeader() {
+    header.offsets[header.layers] = end();
+    if (streamed) return;
+    outfile.seekp(0, std::ios::beg);
+    outfile.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    outfile.seekp(0, std::ios::end);
+  }
+
+  // Writes the header of the streams (binary format)
+  void writeStreamHeader() {
+    DatabaseHeader streamHeader = header;
+    streamHeader.count = DATABASE_STREAM;
+    stream->write(reinterpret_cast<const char *>(&streamHeader), sizeof(streamHeader));
+  }
+
+public:
+
+  // Constructor. The symmetry flag is kept in the header. If an offset is
+  // given, the file is truncated to that offset and the records are appended
+  // to it (resumed generations).
+  RecordWriter(const element N, const bool B, const bool S, const std::string file, const __int64_t offset = -1) {
+    n = N;
+    binary = B;
+    header.magic = DATABASE_MAGIC;
+    header.version = DATABASE_VERSION;
+    header.n = n;
+    header.sign = IS_SIGNED;
+    header.wordBits = databaseWordBits(n, IS_SIGNED);
+    header.symmetry = S;
+    header.layers = 0;
+    header.reserved = 0;
+    header.count = 0;
+    for (int d = 0; d <= DATABASE_LAYERS; ++d)
+      header.offsets[d] = 0;
+    text = NULL;
+    stream = &outfile;
+    streamed = file.compare(DATABASE_STDIO) == 0;
+    open = true;
+    flushed = offset >= 0 ? offset : 0;
+    buffer_index = 0;
+    buffer16 = NULL;
+    buffer32 = NULL;
+    buffer64 = NULL;
+    std::ios::openmode mode = std::ios::out | std::ios::trunc | std::ios::ate;
+    if (offset >= 0) {
+      if (binary) {
+	// The header was rewritten when the offset was taken
+	std::ifstream infile(file, std::ios::in | std::ios::binary);
+	infile.read(reinterpret_cast<char *>(&header), sizeof(header));
+	if (!infile.good() || header.magic != DATABASE_MAGIC || end() != (__uint64_t)offset) {
+	  std::cerr << std::endl << "ERROR!!! The header of " << file;
+	  std::cerr << " does not match the checkpoint." << std::endl << std::endl;
+	  exit(EXIT_FAILURE);
+	}
+      }
+      if (truncate(file.c_str(), offset) != 0) {
+	std::cerr << std::endl << "ERROR!!! Could not truncate file " << file << std::endl << std::endl;
+	exit(EXIT_FAILURE);
+      }
+      mode = std::ios::in | std::ios::out | std::ios::ate;
+    }
+    if (streamed) {
+      stream = &std::cout;
+    } else if (binary) {
+      outfile.open(file, mode | std::ios::binary);
+    } else {
+      outfile.open(file, mode);
+    }
+    if (binary) {
+      switch (header.wordBits) {
+      case 16: buffer16 = new __uint16_t[BUFFER_SIZE]; break;
+      case 32: buffer32 = new __uint32_t[BUFFER_SIZE]; break;
+      default: buffer64 = new __uint64_t[BUFFER_SIZE];
+      }
+    } else {
+      text = new TextBuffer();
+    }
+    if (!streamed && !outfile.is_open()) {
+      std::cerr << std::endl << "ERROR!!! Could not open file " << file << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    if (binary && streamed) writeStreamHeader();
+    else if (binary && offset < 0) writeHeader();
+  }
+
+  // Destructor
+  ~RecordWriter() {
+    close();
+    if (buffer16) delete[] buffer16;
+    if (buffer32) delete[] buffer32;
+    if (buffer64) delete[] buffer64;
+    if (text) delete text;
+  }
+
+  // Writes the permutation (integer format) and its distance
+  void write(const permutation_int intPi, const int distance) {
+    if (binary) {
+      // First record of a new layer
+      if (distance >= DATABASE_LAYERS) {
+	std::cerr << std::endl << "ERROR!!! Distance overflow." << std::endl << std::endl;
+	exit(EXIT_FAILURE);
+      }
+      for (; (int)header.layers <= distance; ++header.layers)
+	header.offsets[header.layers] = end();
+      header.count++;
+      if (buffer16) {
+	buffer16[buffer_index++] = intPi;
+	buffer16[buffer_index++] = distance;
+      } else if (buffer32) {
+	buffer32[buffer_index++] = intPi;
+	buffer32[buffer_index++] = distance;
+      } else {
+	buffer64[buffer_index++] = intPi;
+	buffer64[buffer_index++] = distance;
+      }
+      if (buffer_index == BUFFER_SIZE) flushBuffer();
+    } else {
+      text->record(n, IS_SIGNED, intPi, distance);
+      if (text->full()) flushBuffer();
+    }
+  }
+
+  // Writes the permutation (128-bit integer format) and its distance. Only
+  // text databases keep permutations with more than N_MAX elements.
+  void write(const permutation_wide intPi, const int distance) {
+    text->record(n, IS_SIGNED, intPi, distance);
+    if (text->full()) flushBuffer();
+  }
+
+  // Returns the size of the output written so far (pending records included)
+  __uint64_t written() {
+    if (binary) return end();
+    return flushed + text->size();
+  }
+
+  // Writes the pending records and the header and returns the size of the file
+  __int64_t position() {
+    flushBuffer();
+    if (binary) writeHeader();
+    stream->flush();
+    if (!stream->good()) {
+      std::cerr << std::endl << "ERROR!!! Could not write the output file." << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    return written();
+  }
+
+  // Writes the records of the last layer (called at the end of each layer)
+  void endLayer() {
+    flushBuffer();
+    stream->flush();
+  }
+
+  // Writes the pending records and closes the file
+  void close() {
+    if (!open) return;
+    open = false;
+    flushBuffer();
+    if (binary) writeHeader();
+    stream->flush();
+    if (!streamed) outfile.close();
+  }
+
+};
+
+#endif // __SEARCH_RECORDS__
@@ -21,25 +21,39 @@
 /* Converts a binary database to a text database (signed)                     */
 /******************************************************************************/
 
+#include <thread>
 #include <climits>
 #include <fstream>
 #include <iostream>
 
 #include <linear/signed.hpp>
+#include <format/text.hpp>
+#include <format/mapped.hpp>
+#include <format/compact.hpp>
+#include <format/database.hpp>
 
-#define BUFFER_SIZE 64000
+// Number of records (or ranks of a compact database) of each chunk
+#define CHUNK_SIZE 65536
 
 struct Parameters {
   element n;
   std::string file;
+  bool symmetry;
+  int distance;
+  int threads;
 };
 
 // Prints program usage.
 void printUsage() {
 
-  std::cerr << std::endl << "Usage: signed_bin2txt <n> <i>" << std::endl << std::endl;
+  std::cerr << std::endl << "Usage: signed_bin2txt <n> <i> [--symmetry]" << std::endl << std::endl;
   std::cerr << "  <n>\tPermutation size in the interval [1," << N_MAX << "]" << std::endl;
-  std::cerr << "  <i>\tInput file name (binary format)" << std::endl << std::endl;
+  std::cerr << "  <i>\tInput file name (binary or compact format)" << std::endl;
+  std::cerr << "  --symmetry\tThe database keeps only one permutation of each symmetry" << std::endl;
+  std::cerr << "            \tclass: print all permutations of each class (only for" << std::endl;
+  std::cerr << "            \tdatabases without header)" << std::endl;
+  std::cerr << "  --distance <d>\tPrint only the permutations of distance <d>" << std::endl;
+  std::cerr << "  --threads <t>\tNumber of threads (default: number of cores)" << std::endl << std::endl;
 
   std::cerr << " -----------------------------------------------------------------------" << std::endl;
   std::cerr << " |This program converts a binary database of signed permutations in a  |" << std::endl;
@@ -52,11 +66,14 @@ void printUsage() {
 // Verifies the list of arguments.
 Parameters processArguments(int argc, char* argv[]) {
 
-  if (argc != 3) printUsage();
+  if (argc < 3) printUsage();
 
   Parameters toReturn;
   toReturn.n = 0;
   toReturn.file = "data.in";
+  toReturn.symmetry = false;
+  toReturn.distance = -1;
+  toReturn.threads = std::max(1u, std::thread::hardware_concurrency());
 
   bool error = false;
 
@@ -73,66 +90,176 @@ Parameters processArguments(int argc, char* argv[]) {
 
   toReturn.file = std::string(argv[2]);
 
+  for (int i = 3; i < argc; ++i) {
+    std::string option = std::string(argv[i]);
+    if (option.compare("--symmetry") == 0) {
+      toReturn.symmetry = true;
+    } else if (option.compare("--distance") == 0 && i + 1 < argc) {
+      try {
+	toReturn.distance = std::stoi(argv[++i]);
+	error = toReturn.distance < 0;
+      } catch (const std::exception& ia) {
+	error = true;
+      }
+      if (error) {
+	std::cerr << std::endl << "ERROR!!! Invalid distance.";
+	printUsage();
+      }
+    } else if (option.compare("--threads") == 0 && i + 1 < argc) {
+      try {
+	toReturn.threads = std::stoi(argv[++i]);
+	error = toReturn.threads < 1;
+      } catch (const std::exception& ia) {
+	error = true;
+      }
+      if (error) {
+	std::cerr << std::endl << "ERROR!!! Invalid number of threads.";
+	printUsage();
+      }
+    } else {
+      std::cerr << std::endl << "ERROR!!! Invalid option " << option << ".";
+      printUsage();
+    }
+  }
+
   return toReturn;
 }
 
+// Appends the permutation (integer format) and its distance. With the
+// symmetry flag, all permutations of its symmetry class are appended.
+void printRecord(const Parameters &parameters, const permutation_int intPi,
+		 const __uint64_t distance, TextBuffer &buffer) {
+  permutation_int members[CLASS_SIZE];
+  int size = 1;
+  members[0] = intPi;
+  if (parameters.symmetry)
+    size = permutationClass(parameters.n, IS_SIGNED, intPi, members);
+  for (int m = 0; m < size; ++m)
+    buffer.record(parameters.n, IS_SIGNED, members[m], distance);
+}
+
+// Job of ChunkWriter: records of a binary database (pairs of words)
+template <typename Word>
+struct BinaryChunks {
+  const Parameters &parameters;
+  const Word* words;
+  __uint64_t records;
+  BinaryChunks(const Parameters &P, const __uint8_t *data, const __uint64_t size) :
+    parameters(P), words(reinterpret_cast<const Word*>(data)), records(size / (2 * sizeof(Word))) {}
+  __uint64_t chunks() const { return (records + CHUNK_SIZE - 1) / CHUNK_SIZE; }
+  void operator()(const __uint64_t chunk, TextBuffer &buffer) const {
+    __uint64_t end = std::min(records, (chunk + 1) * CHUNK_SIZE);
+    for (__uint64_t r = chunk * CHUNK_SIZE; r < end; ++r) {
+      if (parameters.distance < 0 || words[2 * r + 1] == (Word)parameters.distance)
+	printRecord(parameters, words[2 * r], words[2 * r + 1], buffer);
+    }
+  }
+};
+
+// Job of ChunkWriter: ranks of the given distance of a compact database
+struct CompactChunks {
+  const Parameters &parameters;
+  const __uint8_t* distances;
+  int bits;
+  __uint64_t count;
+  int layer;
+  CompactChunks(const Parameters &P, const __uint8_t *data, const int B, const __uint64_t C, const int L) :
+    parameters(P), distances(data), bits(B), count(C), layer(L) {}
+  __uint64_t chunks() const { return (count + CHUNK_SIZE - 1) / CHUNK_SIZE; }
+  void operator()(const __uint64_t chunk, TextBuffer &buffer) const {
+    __uint64_t end = std::min(count, (chunk + 1) * CHUNK_SIZE);
+    for (__uint64_t rank = chunk * CHUNK_SIZE; rank < end; ++rank) {
+      if (compactDistance(distances, bits, rank) == layer)
+	printRecord(parameters, rank_to_int(parameters.n, rank), layer, buffer);
+    }
+  }
+};
+
+// Formats the records of the given job with many threads
+template <typename Job>
+void writeChunks(const Parameters &parameters, const Job &job) {
+  ChunkWriter<Job> writer(job, job.chunks(), std::cout);
+  writer.run(parameters.threads);
+}
+
+// Prints a compact database, layer by layer, in the same order as the
+// other formats.
+void processCompact(const Parameters parameters) {
+
+  MappedFile file(parameters.file);
+  const CompactHeader *header = reinterpret_cast<const CompactHeader*>(file.data());
+  if (file.size() < sizeof(CompactHeader) + (header->count * header->bits + 7) / 8 + 1) {
+    std::cerr << std::endl << "ERROR!!! Invalid compact database " << parameters.file << "." << std::endl << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  if (header->n != parameters.n || header->sign != IS_SIGNED) {
+    std::cerr << std::endl << "ERROR!!! The database " << parameters.file;
+    std::cerr << " keeps permutations of a different type or size." << std::endl << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  if (parameters.symmetry) {
+    std::cerr << std::endl << "ERROR!!! Compact databases keep all permutations";
+    std::cerr << " (option --symmetry is not valid)." << std::endl << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  for (int layer = 0; layer <= header->maxDistance; ++layer) {
+    if (parameters.distance >= 0 && layer != parameters.distance) continue;
+    writeChunks(parameters, CompactChunks(parameters, file.data() + sizeof(CompactHeader),
+					  header->bits, header->count, layer));
+  }
+
+}
+
 // Does the real job.
 void process(const Parameters parameters) {
 
-  // Auxiliary permutation
-  permutation_vector vectorPi = permutation_vector(parameters.n);
-
-  int buffer_size = 0;
-  __uint16_t* buffer16 = NULL;
-  __uint32_t* buffer32 = NULL;
-  __uint64_t* buffer64 = NULL;
-
-  if (parameters.n < 4) {
-    buffer16 = new __uint16_t[BUFFER_SIZE];
-    buffer_size = BUFFER_SIZE * sizeof(__uint16_t);
-  } else if (parameters.n < 7) {
-    buffer32 = new __uint32_t[BUFFER_SIZE];
-    buffer_size = BUFFER_SIZE * sizeof(__uint32_t);
-  } else {
-    buffer64 = new __uint64_t[BUFFER_SIZE];
-    buffer_size = BUFFER_SIZE * sizeof(__uint64_t);
+  if (isCompactFile(parameters.file)) {
+    processCompact(parameters);
+    return;
   }
 
-  std::ifstream infile;
-  infile.open(parameters.file, std::ios::in | std::ios::ate | std::ios::binary);
-  infile.seekg (0, std::ios::beg);
-  while (!infile.eof()) {
-    if (parameters.n < 4) {
-      infile.read(reinterpret_cast<char *>(buffer16), buffer_size);
-      int n = infile.gcount() / sizeof(__uint16_t);
-      for (int i = 0; i < n; i+=2) {
-	int_to_vector(parameters.n, buffer16[i], vectorPi);
-	print(parameters.n, vectorPi, std::cout);
-	std::cout << " " << buffer16[i + 1] << std::endl;
-      }
-    } else if (parameters.n < 7) {
-      infile.read(reinterpret_cast<char *>(buffer32), buffer_size);
-      int n = infile.gcount() / sizeof(__uint32_t);
-      for (int i = 0; i < n; i+=2) {
-	int_to_vector(parameters.n, buffer32[i], vectorPi);
-	print(parameters.n, vectorPi, std::cout);
-	std::cout << " " << buffer32[i + 1] << std::endl;
-      }
-    } else {
-      infile.read(reinterpret_cast<char *>(buffer64), buffer_size);
-      int n = infile.gcount() / sizeof(__uint64_t);
-      for (int i = 0; i < n; i+=2) {
-	int_to_vector(parameters.n, buffer64[i], vectorPi);
-	print(parameters.n, vectorPi, std::cout);
-	std::cout << " " << buffer64[i + 1] << std::endl;
-      }
+  Parameters options = parameters;
+
+  // Interval of the file to be printed
+  MappedFile file(parameters.file);
+  __uint64_t begin = 0;
+  __uint64_t end = file.size();
+  DatabaseHeader header;
+  if (readDatabaseHeader(parameters.file, header)) {
+    if (header.n != parameters.n || header.sign != IS_SIGNED) {
+      std::cerr << std::endl << "ERROR!!! The database " << parameters.file;
+      std::cerr << " keeps permutations of a different type or size." << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    if (parameters.symmetry && !header.symmetry) {
+      std::cerr << std::endl << "ERROR!!! The database " << parameters.file;
+      std::cerr << " does not keep symmetry classes." << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    options.symmetry = header.symmetry;
+    begin = sizeof(header);
+    if (parameters.distance >= (int)header.layers) {
+      begin = end;
+    } else if (parameters.distance >= 0) {
+      begin = header.offsets[parameters.distance];
+      end = header.offsets[parameters.distance + 1];
     }
   }
-  infile.close();
 
-  if (buffer16) delete buffer16;
-  if (buffer32) delete buffer32;
-  if (buffer64) delete buffer64;
+  // The records are read in order, once
+  madvise(const_cast<__uint8_t*>(file.data()), file.size(), MADV_SEQUENTIAL);
+
+  switch (databaseWordBits(parameters.n, IS_SIGNED)) {
+  case 16:
+    writeChunks(options, BinaryChunks<__uint16_t>(options, file.data() + begin, end - begin));
+    break;
+  case 32:
+    writeChunks(options, BinaryChunks<__uint32_t>(options, file.data() + begin, end - begin));
+    break;
+  default:
+    writeChunks(options, BinaryChunks<__uint64_t>(options, file.data() + begin, end - begin));
+  }
 
 }
 
@@ -0,0 +1,126 @@
+/******************************************************************************/
+/*                                                                            */
+/*   This file is part of SWI-LS.                                             */
+/*                                                                            */
+/*   SWI-LS is free software: you can redistribute it and/or modify           */
+/*   it under the terms of the GNU General Public License as published by     */
+/*   the Free Software Foundation, either version 2 of the License, or        */
+/*   any later version.                                                       */
+/*                                                                            */
+/*   SWI-LS is distributed in the hope that it will be useful,                */
+/*   but WITHOUT ANY WARRANTY; without even the implied warranty of           */
+/*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            */
+/*   GNU General Public License for more details.                             */
+/*                                                                            */
+/*   You should have received a copy of the GNU General Public License        */
+/*   along with SWI-LS.  If not, see <http://www.gnu.org/licenses/>.          */
+/*                                                                            */
+/******************************************************************************/
+
+/******************************************************************************/
+/* Sorts a signed permutation optimally by following a policy table           */
+/******************************************************************************/
+
+#include <string>
+#include <iostream>
+
+#include <linear/signed.hpp>
+#include <problem/problem.hpp>
+#include <format/policy.hpp>
+
+struct Parameters {
+  std::string table;
+  permutation_vector permutation;
+};
+
+// Prints program usage.
+void printUsage() {
+
+  std::cerr << std::endl << "Usage: sort_signed <t> <p>" << std::endl << std::endl;
+  std::cerr << "  <t>\tPolicy table (generated by signed_database --policy)" << std::endl;
+  std::cerr << "  <p>\tPermutation (elements separated by comma) of the size of the table" << std::endl << std::endl;
+
+  std::cerr << " -----------------------------------------------------------------------" << std::endl;
+  std::cerr << " |This program prints an optimal sequence of inversions which sorts the|" << std::endl;
+  std::cerr << " |given signed permutation (positions in the interval [1,n]) and its   |" << std::endl;
+  std::cerr << " |total weight.                                                        |" << std::endl;
+  std::cerr << " -----------------------------------------------------------------------" << std::endl << std::endl;
+
+  exit(EXIT_FAILURE);
+}
+
+// Returns true if the given vector is a signed permutation of size n.
+bool isPermutation(const element n, const permutation_vector &pi) {
+  if ((element)pi.size() != n) return false;
+  std::vector<bool> used(n + 1, false);
+  for (element i = 0; i < n; ++i) {
+    element e = pi[i];
+    if (e == 0 || abs(e) > n || used[abs(e)]) return false;
+    used[abs(e)] = true;
+  }
+  return true;
+}
+
+// Verifies the list of arguments.
+Parameters processArguments(int argc, char* argv[]) {
+
+  if (argc != 3) printUsage();
+
+  Parameters toReturn;
+  toReturn.table = std::string(argv[1]);
+
+  std::string aux = std::string(argv[2]);
+  size_t index = 0;
+  try {
+    while (index <= aux.length()) {
+      size_t comma = aux.find_first_of(",", index);
+      if (comma == std::string::npos) comma = aux.length();
+      toReturn.permutation.push_back(std::stoi(aux.substr(index, comma - index)));
+      index = comma + 1;
+    }
+  } catch (const std::exception& ia) {
+    std::cerr << std::endl << "ERROR!!! Could not parse the permutation string.";
+    printUsage();
+  }
+
+  return toReturn;
+}
+
+// Does the real job.
+void process(const Parameters parameters) {
+
+  PolicyTable table(parameters.table);
+  element n = table.size();
+  if (table.isSigned() != IS_SIGNED || !isPermutation(n, parameters.permutation)) {
+    std::cerr << std::endl << "ERROR!!! The permutation is not a signed permutation of size ";
+    std::cerr << n << " (size of the policy table)." << std::endl << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  inversion_list list = getPossibleInversions(SWI_LS, n, IS_SIGNED);
+  if ((int)list.size() != table.inversions()) {
+    std::cerr << std::endl << "ERROR!!! The policy table was generated with other inversions." << std::endl << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  // Follow the table until the identity
+  permutation_int intPi = vector_to_int(n, parameters.permutation);
+  int total = 0;
+  for (int k = table.inversion(intPi); k != NO_INVERSION; k = table.inversion(intPi)) {
+    if (k >= (int)list.size()) {
+      std::cerr << std::endl << "ERROR!!! Invalid policy table." << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    std::cout << "[" << list[k].i + 1 << "," << list[k].j + 1 << "] weight=" << list[k].w << std::endl;
+    total += list[k].w;
+    intPi = applyInversionInt(n, list[k].i, list[k].j, intPi);
+  }
+  std::cout << "Total weight: " << total << std::endl;
+
+}
+
+// Main program
+int main (int argc, char* argv[]) {
+  process(processArguments(argc, argv));
+  return 0;
+}
@@ -21,31 +21,82 @@
 /* Generates a database of signed permutations of size N                      */
 /******************************************************************************/
 
-#include <map>
-#include <queue>
-#include <climits>
-#include <fstream>
+#include <thread>
 #include <iostream>
-#include <unordered_set>
+#include <sys/stat.h>
 
 #include <linear/unsigned.hpp>
-#include <problem/problem.hpp>
-
-#define BUFFER_SIZE 64000
+#include <search/dense.hpp>
+#include <search/external.hpp>
+#include <search/partitioned.hpp>
+#include <search/ball.hpp>
 
 struct Parameters {
   element n;
   bool binary;
+  bool compact;
   std::string file;
+  int threads;
+  __uint64_t memoryBudget;
+  int workers;
+  int worker;
+  std::string spool;
+  std::string directory;
+  bool symmetry;
+  std::string checkpoint;
+  int checkpointInterval;
+  bool resume;
+  std::string policy;
+  int radius;
+  std::string progress;
+  int progressInterval;
 };
 
 // Prints program usage.
 void printUsage() {
 
-  std::cerr << std::endl << "Usage: unsigned_database <n> <b> <o>" << std::endl << std::endl;
-  std::cerr << "  <n>\tPermutation size in the interval [1," << N_MAX << "]" << std::endl;
-  std::cerr << "  <b>\tOutput format: 0 - text or 1 - binary" << std::endl;
-  std::cerr << "  <o>\tOutput file name" << std::endl << std::endl;
+  std::cerr << std::endl << "Usage: unsigned_database <n> <b> <o> [options]" << std::endl << std::endl;
+  std::cerr << "  <n>\tPermutation size in the interval [1," << N_MAX << "] (up to " << N_MAX_WIDE << std::endl;
+  std::cerr << "     \twith --radius and the text format)" << std::endl;
+  std::cerr << "  <b>\tOutput format: 0 - text, 1 - binary or 2 - compact (only the" << std::endl;
+  std::cerr << "     \tdistances, bit-packed in rank order)" << std::endl;
+  std::cerr << "  <o>\tOutput file name (" << DATABASE_STDIO << " for the standard output, with the text or" << std::endl;
+  std::cerr << "     \tbinary format)" << std::endl << std::endl;
+  std::cerr << "Options:" << std::endl;
+  std::cerr << "  --threads <t>\tNumber of threads (default: number of cores)" << std::endl;
+  std::cerr << "  --memory-budget <m>\tKeep the search on disk (sorted run files), using" << std::endl;
+  std::cerr << "                     \tat most <m> MB of RAM (single thread)" << std::endl;
+  std::cerr << "  --workers <w>\tSplit the search in <w> processes, each one with a range of" << std::endl;
+  std::cerr << "               \tranks, exchanging permutations through files (the memory" << std::endl;
+  std::cerr << "               \tbudget is the one of each process, default: " << PARTITION_BUDGET << " MB)" << std::endl;
+  std::cerr << "  --spool <d>\tShared directory of the workers: with --workers, the workers" << std::endl;
+  std::cerr << "             \tare not started by this process but by hand, with --worker" << std::endl;
+  std::cerr << "             \t(on any machine which shares <d>). The search stops if a" << std::endl;
+  std::cerr << "             \tworker sends no heartbeat for " << PARTITION_TIMEOUT << " seconds" << std::endl;
+  std::cerr << "  --worker <w>/<W>\tRun only the worker <w> (from 0) of a search with" << std::endl;
+  std::cerr << "                  \t--workers <W> and --spool (the same <n> and --symmetry;" << std::endl;
+  std::cerr << "                  \tthe output file is written by the coordinator)" << std::endl;
+  std::cerr << "  --temp-dir <d>\tTemporary directory used with --memory-budget and" << std::endl;
+  std::cerr << "                \t--workers (default: <o>.tmp)" << std::endl;
+  std::cerr << "  --symmetry\tKeep only one permutation (the smallest) of each class of" << std::endl;
+  std::cerr << "            \tpermutations with the same distance by symmetry: inverse," << std::endl;
+  std::cerr << "            \tmirror and mirror of the inverse" << std::endl;
+  std::cerr << "  --checkpoint <c>\tSave the state of the search in the file <c> at the" << std::endl;
+  std::cerr << "                  \tend of the layers (not with --memory-budget)" << std::endl;
+  std::cerr << "  --checkpoint-interval <i>\tMinimum interval between checkpoints, in" << std::endl;
+  std::cerr << "                           \tminutes (default: 60)" << std::endl;
+  std::cerr << "  --resume\tContinue the generation saved in the checkpoint file, appending" << std::endl;
+  std::cerr << "          \tthe records to the output file" << std::endl;
+  std::cerr << "  --policy <p>\tAlso write the policy table (one optimal inversion of" << std::endl;
+  std::cerr << "              \teach permutation) in the file <p> (not with --memory-budget)" << std::endl;
+  std::cerr << "  --radius <r>\tGenerate only the permutations up to distance <r>, kept in" << std::endl;
+  std::cerr << "              \ta hash table (not with the options above)" << std::endl;
+  std::cerr << "  --progress <f>\tWrite progress records (JSON lines) and a final summary" << std::endl;
+  std::cerr << "                \t(histogram of distances and diameter) in the file <f>" << std::endl;
+  std::cerr << "                \t(- for the standard error)" << std::endl;
+  std::cerr << "  --progress-interval <s>\tInterval between the progress records written" << std::endl;
+  std::cerr << "                         \twhile a layer is expanded, in seconds (default:" << std::endl;
+  std::cerr << "                         \t60, 0 for only one record per layer)" << std::endl << std::endl;
 
   std::cerr << " ------------------------------------------------------------------------" << std::endl;
   std::cerr << " |This program generates database files containing all possible unsigned|" << std::endl;
@@ -56,8 +107,10 @@ void printUsage() {
   std::cerr << " ------------------------------------------------------------------------" << std::endl << std::endl;
 
   std::cerr << " -------------------------------------------------------------------------" << std::endl;
-  std::cerr << " |WARNING: This program may require huge amount of memory. For n=12, it  |" << std::endl;
-  std::cerr << " |requires approximately 40GB of RAM.                                    |" << std::endl;
+  std::cerr << " |WARNING: This program requires 3 or 4 bits of RAM per                  |" << std::endl;
+  std::cerr << " |permutation (one byte with the compact format or --policy).            |" << std::endl;
+  std::cerr << " |For n=13, it requires approximately 3.1GB of RAM (6.2GB with           |" << std::endl;
+  std::cerr << " |one byte per permutation).                                             |" << std::endl;
   std::cerr << " -------------------------------------------------------------------------" << std::endl << std::endl;
 
   exit(EXIT_FAILURE);
@@ -66,18 +119,27 @@ void printUsage() {
 // Verifies the list of arguments
 Parameters processArguments(int argc, char* argv[]) {
 
-  if (argc != 4) printUsage();
+  if (argc < 4) printUsage();
 
   Parameters toReturn;
   toReturn.n = 0;
   toReturn.binary = true;
   toReturn.file = "data.out";
+  toReturn.threads = std::max(1u, std::thread::hardware_concurrency());
+  toReturn.memoryBudget = 0;
+  toReturn.workers = 0;
+  toReturn.worker = -1;
+  toReturn.symmetry = false;
+  toReturn.checkpointInterval = 60;
+  toReturn.resume = false;
+  toReturn.radius = -1;
+  toReturn.progressInterval = 60;
 
   bool error = false;
 
   try {
     toReturn.n = std::stoi(argv[1]);
-    error = toReturn.n < 1 || toReturn.n > N_MAX;
+    error = toReturn.n < 1 || toReturn.n > N_MAX_WIDE;
   } catch (const std::exception& ia) {
     error = true;
   }
@@ -87,8 +149,157 @@ Parameters processArguments(int argc, char* argv[]) {
   }
 
   toReturn.binary = std::string(argv[2]).compare("1") == 0;
+  toReturn.compact = std::string(argv[2]).compare("2") == 0;
 
   toReturn.file = std::string(argv[3]);
+  toReturn.directory = toReturn.file + ".tmp";
+
+  for (int i = 4; i < argc; ++i) {
+    std::string option = std::string(argv[i]);
+    if (option.compare("--threads") == 0 && i + 1 < argc) {
+      try {
+	toReturn.threads = std::stoi(argv[++i]);
+	error = toReturn.threads < 1;
+      } catch (const std::exception& ia) {
+	error = true;
+      }
+      if (error) {
+	std::cerr << std::endl << "ERROR!!! Invalid number of threads.";
+	printUsage();
+      }
+    } else if (option.compare("--memory-budget") == 0 && i + 1 < argc) {
+      try {
+	long long int megabytes = std::stoll(argv[++i]);
+	error = megabytes < 1;
+	toReturn.memoryBudget = megabytes * 1024 * 1024;
+      } catch (const std::exception& ia) {
+	error = true;
+      }
+      if (error) {
+	std::cerr << std::endl << "ERROR!!! Invalid memory budget.";
+	printUsage();
+      }
+    } else if (option.compare("--workers") == 0 && i + 1 < argc) {
+      try {
+	toReturn.workers = std::stoi(argv[++i]);
+	error = toReturn.workers < 1;
+      } catch (const std::exception& ia) {
+	error = true;
+      }
+      if (error) {
+	std::cerr << std::endl << "ERROR!!! Invalid number of workers.";
+	printUsage();
+      }
+    } else if (option.compare("--worker") == 0 && i + 1 < argc) {
+      std::string worker = std::string(argv[++i]);
+      size_t slash = worker.find('/');
+      try {
+	toReturn.worker = std::stoi(worker.substr(0, slash));
+	toReturn.workers = std::stoi(worker.substr(slash + 1));
+	error = slash == std::string::npos || toReturn.worker < 0 || toReturn.worker >= toReturn.workers;
+      } catch (const std::exception& ia) {
+	error = true;
+      }
+      if (error) {
+	std::cerr << std::endl << "ERROR!!! Invalid worker.";
+	printUsage();
+      }
+    } else if (option.compare("--spool") == 0 && i + 1 < argc) {
+      toReturn.spool = std::string(argv[++i]);
+    } else if (option.compare("--temp-dir") == 0 && i + 1 < argc) {
+      toReturn.directory = std::string(argv[++i]);
+    } else if (option.compare("--symmetry") == 0) {
+      toReturn.symmetry = true;
+    } else if (option.compare("--checkpoint") == 0 && i + 1 < argc) {
+      toReturn.checkpoint = std::string(argv[++i]);
+    } else if (option.compare("--checkpoint-interval") == 0 && i + 1 < argc) {
+      try {
+	toReturn.checkpointInterval = std::stoi(argv[++i]);
+	error = toReturn.checkpointInterval < 0;
+      } catch (const std::exception& ia) {
+	error = true;
+      }
+      if (error) {
+	std::cerr << std::endl << "ERROR!!! Invalid checkpoint interval.";
+	printUsage();
+      }
+    } else if (option.compare("--resume") == 0) {
+      toReturn.resume = true;
+    } else if (option.compare("--policy") == 0 && i + 1 < argc) {
+      toReturn.policy = std::string(argv[++i]);
+    } else if (option.compare("--radius") == 0 && i + 1 < argc) {
+      try {
+	toReturn.radius = std::stoi(argv[++i]);
+	error = toReturn.radius < 0;
+      } catch (const std::exception& ia) {
+	error = true;
+      }
+      if (error) {
+	std::cerr << std::endl << "ERROR!!! Invalid radius.";
+	printUsage();
+      }
+    } else if (option.compare("--progress") == 0 && i + 1 < argc) {
+      toReturn.progress = std::string(argv[++i]);
+    } else if (option.compare("--progress-interval") == 0 && i + 1 < argc) {
+      try {
+	toReturn.progressInterval = std::stoi(argv[++i]);
+	error = toReturn.progressInterval < 0;
+      } catch (const std::exception& ia) {
+	error = true;
+      }
+      if (error) {
+	std::cerr << std::endl << "ERROR!!! Invalid progress interval.";
+	printUsage();
+      }
+    } else {
+      std::cerr << std::endl << "ERROR!!! Invalid option " << option << ".";
+      printUsage();
+    }
+  }
+
+  if (toReturn.file.compare(DATABASE_STDIO) == 0 && (toReturn.compact || !toReturn.checkpoint.empty())) {
+    std::cerr << std::endl << "ERROR!!! The standard output cannot be used with the compact format or";
+    std::cerr << " with --checkpoint.";
+    printUsage();
+  }
+  if (toReturn.resume && toReturn.checkpoint.empty()) {
+    std::cerr << std::endl << "ERROR!!! Option --resume requires --checkpoint.";
+    printUsage();
+  }
+  if (toReturn.compact && toReturn.memoryBudget > 0) {
+    std::cerr << std::endl << "ERROR!!! The compact format cannot be used with --memory-budget.";
+    printUsage();
+  }
+  if (!toReturn.policy.empty() && toReturn.memoryBudget > 0) {
+    std::cerr << std::endl << "ERROR!!! Option --policy cannot be used with --memory-budget.";
+    printUsage();
+  }
+  if (!toReturn.checkpoint.empty() && toReturn.memoryBudget > 0) {
+    std::cerr << std::endl << "ERROR!!! Option --checkpoint cannot be used with --memory-budget.";
+    printUsage();
+  }
+
+  if (toReturn.workers > 0 && (toReturn.compact || !toReturn.checkpoint.empty() ||
+				 !toReturn.policy.empty() || toReturn.radius >= 0)) {
+    std::cerr << std::endl << "ERROR!!! Option --workers cannot be used with the compact format or with";
+    std::cerr << " --checkpoint, --policy and --radius.";
+    printUsage();
+  }
+  if ((toReturn.worker >= 0 || !toReturn.spool.empty()) && (toReturn.workers == 0 || toReturn.spool.empty())) {
+    std::cerr << std::endl << "ERROR!!! Options --worker and --spool require --spool and --workers (or --worker).";
+    printUsage();
+  }
+  if (toReturn.radius >= 0 && (toReturn.compact || toReturn.memoryBudget > 0 || toReturn.symmetry ||
+				!toReturn.checkpoint.empty() || !toReturn.policy.empty())) {
+    std::cerr << std::endl << "ERROR!!! Option --radius cannot be used with the compact format or with";
+    std::cerr << " --memory-budget, --symmetry, --checkpoint and --policy.";
+    printUsage();
+  }
+  if (toReturn.n > N_MAX && (toReturn.radius < 0 || toReturn.binary)) {
+    std::cerr << std::endl << "ERROR!!! Permutations with more than " << N_MAX;
+    std::cerr << " elements require --radius and the text format.";
+    printUsage();
+  }
 
   return toReturn;
 }
@@ -96,172 +307,71 @@ Parameters processArguments(int argc, char* argv[]) {
 // Does the real job.
 void process(const Parameters parameters) {
 
-  // Auxiliary variables
-  inversion_list_it it;
-  int currentDistance;
-  int newDistance;
-  int oldDistance;
-  int minDistance;
-
-
-  // Auxiliary permutations
-  permutation_int intPi;
-  permutation_int intSigma;
-
-  // Create two permutation vectors of size n
-  permutation_vector vectorPi    = permutation_vector(parameters.n);
-  permutation_vector vectorSigma = permutation_vector(parameters.n);
-
-  // Fill pi with the identity permutation
-  identityPermutation(parameters.n, vectorPi);
-
-  // Get the identity permutation on int format
-  intPi = vector_to_int(parameters.n, vectorPi);
-
-  // Get the list of inversions considering the given problem:
-  inversion_list list = getPossibleInversions(SWI_LS, parameters.n, true);
-
-
-  // Time to run dijkstra
-  std::unordered_set<permutation_int> visited;
+  Progress *progress = NULL;
+  if (!parameters.progress.empty())
+    progress = new Progress(parameters.progress, parameters.progressInterval);
 
-  std::map<permutation_int,int> distances = std::map<permutation_int,int>();
-  std::map<permutation_int,int>::iterator map_it;
-
-  std::queue<permutation_int> queue = std::queue<permutation_int>();
-
-  distances[intPi] = 0;
-  queue.push(intPi);
-
-  int buffer_size = 0;
-  int buffer_index = 0;
-  __uint16_t* buffer16 = NULL;
-  __uint32_t* buffer32 = NULL;
-  __uint64_t* buffer64 = NULL;
-
-  std::ofstream outfile;
-
-  if (parameters.binary) {
-    outfile.open(parameters.file, std::ios::out | std::ios::trunc | std::ios::ate | std::ios::binary);
-    if (parameters.n < 5) {
-      buffer16 = new __uint16_t[BUFFER_SIZE];
-      buffer_size = BUFFER_SIZE * sizeof(__uint16_t);
-    } else if (parameters.n < 9) {
-      buffer32 = new __uint32_t[BUFFER_SIZE];
-      buffer_size = BUFFER_SIZE * sizeof(__uint32_t);
+  if (parameters.radius >= 0) {
+    RecordWriter output(parameters.n, parameters.binary, false, parameters.file);
+    if (parameters.n > N_MAX) {
+      BallSearch<permutation_wide> search(parameters.n, parameters.threads, parameters.radius);
+      search.setProgress(progress);
+      search.run(output);
     } else {
-      buffer64 = new __uint64_t[BUFFER_SIZE];
-      buffer_size = BUFFER_SIZE * sizeof(__uint64_t);
+      BallSearch<permutation_int> search(parameters.n, parameters.threads, parameters.radius);
+      search.setProgress(progress);
+      search.run(output);
     }
-  } else {
-    outfile.open(parameters.file, std::ios::out | std::ios::trunc | std::ios::ate);
-  }
-
-  while (queue.size() > 0) {
-
-    // Pop the first element of the queue
-    intPi = queue.front();
-    queue.pop();
-
-    // Get the distance and remove it from the map
-    map_it = distances.find(intPi);
-    currentDistance = (*map_it).second;
-    distances.erase(map_it);
-
-    // Transform the int into a vector
-    int_to_vector(parameters.n, intPi, vectorPi);
-
-    // Print the permutation and the distance
-    if (parameters.binary) {
-      if (parameters.n < 5) {
-	buffer16[buffer_index++] = intPi;
-	buffer16[buffer_index++] = currentDistance;
-	if (buffer_index == BUFFER_SIZE) {
-	  outfile.write(reinterpret_cast<const char *>(buffer16), buffer_size);
-	  buffer_index = 0;
-	}
-      } else if (parameters.n < 9) {
-	buffer32[buffer_index++] = intPi;
-	buffer32[buffer_index++] = currentDistance;
-	if (buffer_index == BUFFER_SIZE) {
-	  outfile.write(reinterpret_cast<const char *>(buffer32), buffer_size);
-	  buffer_index = 0;
-	}
-      } else {
-	buffer64[buffer_index++] = intPi;
-	buffer64[buffer_index++] = currentDistance;
-	if (buffer_index == BUFFER_SIZE) {
-	  outfile.write(reinterpret_cast<const char *>(buffer64), buffer_size);
-	  buffer_index = 0;
-	}
-      }
+    output.close();
+  } else if (parameters.workers > 0) {
+    __uint64_t budget = parameters.memoryBudget;
+    if (budget == 0) budget = (__uint64_t)PARTITION_BUDGET * 1024 * 1024;
+    std::string directory = parameters.spool.empty() ? parameters.directory : parameters.spool;
+    PartitionedSearch search(parameters.n, parameters.workers, budget, directory, parameters.symmetry);
+    if (parameters.worker >= 0) {
+      search.serve(parameters.worker);
     } else {
-      print(parameters.n, vectorPi, outfile);
-      outfile << " " << currentDistance << std::endl;
-    }
-
-    // Insert the permutation into the visited set
-    visited.insert(intPi);
-
-    // Try all inversions over the permutation
-    for (it = list.begin(); it != list.end(); ++it) {
-      inversion_info info = *it;
-      applyInversion(info.i, info.j, vectorPi, vectorSigma);
-      intSigma = vector_to_int(parameters.n, vectorSigma);
-
-      if (visited.find(intSigma) == visited.end()) {
-	// This permutation is not marked as visited
-	newDistance = currentDistance + info.w;
-	// Verify if it is in the map
-	map_it = distances.find(intSigma);
-	if (map_it == distances.end()) {
-	  // First time this permutation appears
-	  distances[intSigma] = newDistance;
-	} else {
-	  // We compare the old distance
-	  oldDistance = (*map_it).second;
-	  if (oldDistance > newDistance)
-	    distances[intSigma] = newDistance;
-	}
-      }
+      RecordWriter output(parameters.n, parameters.binary, parameters.symmetry, parameters.file);
+      search.setLaunch(parameters.spool.empty());
+      search.setProgress(progress);
+      search.run(output);
+      output.close();
     }
-
-    // The queue is empty, look for the next group of permutations
-    if (queue.size() == 0) {
-      minDistance = INT_MAX;
-      for (map_it = distances.begin(); map_it != distances.end(); ++map_it) {
-	if (minDistance > (*map_it).second) {
-	  // Empty the queue
-	  std::queue<permutation_int> empty;
-	  std::swap(queue, empty);
-	  // Add the permutation and updated the distance
-	  queue.push((*map_it).first);
-	  minDistance = (*map_it).second;
-	} else if (minDistance == (*map_it).second) {
-	  // Just add the element
-	  queue.push((*map_it).first);
-	}
-      }
-    }
-
-  }
-
-  if (parameters.binary && buffer_index > 0) {
-    if (parameters.n < 5) {
-      outfile.write(reinterpret_cast<const char *>(buffer16), buffer_index * sizeof(__uint16_t));
-    } else if (parameters.n < 9) {
-      outfile.write(reinterpret_cast<const char *>(buffer32), buffer_index * sizeof(__uint32_t));
+  } else if (parameters.memoryBudget > 0) {
+    RecordWriter output(parameters.n, parameters.binary, parameters.symmetry, parameters.file);
+    ExternalSearch search(parameters.n, parameters.memoryBudget, parameters.directory, parameters.symmetry);
+    search.setProgress(progress);
+    search.run(output);
+    output.close();
+  } else {
+    DenseSearch search(parameters.n, parameters.threads, parameters.symmetry,
+		       !parameters.compact && parameters.policy.empty());
+    search.setProgress(progress);
+    __int64_t offset = -1;
+    if (parameters.resume)
+      offset = search.restore(parameters.checkpoint);
+    if (!parameters.checkpoint.empty())
+      search.setCheckpoint(parameters.checkpoint, parameters.checkpointInterval * 60);
+    if (parameters.compact) {
+      search.run(NULL);
+      search.writeCompact(parameters.file);
     } else {
-      outfile.write(reinterpret_cast<const char *>(buffer64), buffer_index * sizeof(__uint64_t));
+      RecordWriter output(parameters.n, parameters.binary, parameters.symmetry, parameters.file, offset);
+      search.run(&output);
+      output.close();
     }
+    if (!parameters.policy.empty())
+      search.writePolicy(parameters.policy);
   }
 
-  outfile.flush();
-  outfile.close();
-
-  if (buffer16) delete buffer16;
-  if (buffer32) delete buffer32;
-  if (buffer64) delete buffer64;
+  // Summary (the size of the output is the one of the final file, not known
+  // for the standard output)
+  if (progress) {
+    struct stat status;
+    bool file = parameters.file.compare(DATABASE_STDIO) != 0 && stat(parameters.file.c_str(), &status) == 0;
+    progress->finish(file ? status.st_size : 0);
+    delete progress;
+  }
 
 }
 
@@ -0,0 +1,445 @@
+/******************************************************************************/
+/*                                                                            */
+/*   This file is part of SWI-LS.                                             */
+/*                                                                            */
+/*   SWI-LS is free software: you can redistribute it and/or modify           */
+/*   it under the terms of the GNU General Public License as published by     */
+/*   the Free Software Foundation, either version 2 of the License, or        */
+/*   any later version.                                                       */
+/*                                                                            */
+/*   SWI-LS is distributed in the hope that it will be useful,                */
+/*   but WITHOUT ANY WARRANTY; without even the implied warranty of           */
+/*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            */
+/*   GNU General Public License for more details.                             */
+/*                                                                            */
+/*   You should have received a copy of the GNU General Public License        */
+/*   along with SWI-LS.  If not, see <http://www.gnu.org/licenses/>.          */
+/*                                                                            */
+/******************************************************************************/
+
+/******************************************************************************/
+/* Verifies the distances of a database (Bellman equations)                   */
+/******************************************************************************/
+
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <iostream>
+#include <algorithm>
+
+#include <linear/keys.hpp>
+#include <linear/ranking.hpp>
+#include <linear/symmetry.hpp>
+#include <problem/problem.hpp>
+#include <format/mapped.hpp>
+#include <format/compact.hpp>
+#include <format/database.hpp>
+
+// Number of ranks (or records) processed at once by each thread
+#define VERIFY_CHUNK 65536
+
+// Distance of the ranks without a record
+#define MISSING 255
+
+// Expected distance of the records which are not representatives
+#define NOT_CANONICAL -2
+
+struct Parameters {
+  int n;
+  bool sign;
+  std::string file;
+  int threads;
+  bool symmetry;
+  int errors;
+};
+
+// Inconsistent record: rank, distance in the database and expected distance
+// (MISSING for ranks without a record, -1 for invalid or repeated records and
+// NOT_CANONICAL for records of symmetry databases which are not the
+// representatives of their classes)
+struct Inconsistency {
+  __uint64_t rank;
+  int distance;
+  int expected;
+  bool operator<(const Inconsistency &other) const { return rank < other.rank; }
+};
+
+// Prints program usage.
+void printUsage() {
+
+  std::cerr << std::endl << "Usage: verify_database <n> <s> <i> [options]" << std::endl << std::endl;
+  std::cerr << "  <n>\tPermutation size in the interval [1,16] (12 for signed permutations)" << std::endl;
+  std::cerr << "  <s>\t0 = unsigned permutations or 1 = signed permutations" << std::endl;
+  std::cerr << "  <i>\tInput file name (binary or compact format)" << std::endl << std::endl;
+  std::cerr << "Options:" << std::endl;
+  std::cerr << "  --threads <t>\tNumber of threads (default: number of cores)" << std::endl;
+  std::cerr << "  --symmetry\tThe database keeps only one permutation of each symmetry" << std::endl;
+  std::cerr << "            \tclass (only for databases without header)" << std::endl;
+  std::cerr << "  --errors <e>\tNumber of inconsistent records printed (default: 10)" << std::endl << std::endl;
+
+  std::cerr << " -----------------------------------------------------------------------" << std::endl;
+  std::cerr << " |This program verifies a database: the identity must have distance 0 |" << std::endl;
+  std::cerr << " |and the distance of every other permutation must be the minimum, over|" << std::endl;
+  std::cerr << " |all inversions, of the weight of the inversion plus the distance of  |" << std::endl;
+  std::cerr << " |the resulting permutation. It prints the first inconsistent records  |" << std::endl;
+  std::cerr << " |and a checksum of the distances, which does not depend on the format |" << std::endl;
+  std::cerr << " |(a symmetry class counts once for each of its members).              |" << std::endl;
+  std::cerr << " -----------------------------------------------------------------------" << std::endl << std::endl;
+
+  exit(EXIT_FAILURE);
+}
+
+// Verifies the list of arguments.
+Parameters processArguments(int argc, char* argv[]) {
+
+  if (argc < 4) printUsage();
+
+  Parameters toReturn;
+  toReturn.n = 0;
+  toReturn.threads = std::max(1u, std::thread::hardware_concurrency());
+  toReturn.symmetry = false;
+  toReturn.errors = 10;
+
+  bool error = false;
+
+  toReturn.sign = std::string(argv[2]).compare("1") == 0;
+
+  try {
+    toReturn.n = std::stoi(argv[1]);
+    error = toReturn.n < 1 || toReturn.n > keyMaxSize<__uint64_t>(toReturn.sign);
+  } catch (const std::exception& ia) {
+    error = true;
+  }
+  if (error) {
+    std::cerr << std::endl << "ERROR!!! Invalid permutation size.";
+    printUsage();
+  }
+
+  toReturn.file = std::string(argv[3]);
+
+  for (int i = 4; i < argc; ++i) {
+    std::string option = std::string(argv[i]);
+    if (option.compare("--threads") == 0 && i + 1 < argc) {
+      try {
+	toReturn.threads = std::stoi(argv[++i]);
+	error = toReturn.threads < 1;
+      } catch (const std::exception& ia) {
+	error = true;
+      }
+      if (error) {
+	std::cerr << std::endl << "ERROR!!! Invalid number of threads.";
+	printUsage();
+      }
+    } else if (option.compare("--symmetry") == 0) {
+      toReturn.symmetry = true;
+    } else if (option.compare("--errors") == 0 && i + 1 < argc) {
+      try {
+	toReturn.errors = std::stoi(argv[++i]);
+	error = toReturn.errors < 0;
+      } catch (const std::exception& ia) {
+	error = true;
+      }
+      if (error) {
+	std::cerr << std::endl << "ERROR!!! Invalid number of errors.";
+	printUsage();
+      }
+    } else {
+      std::cerr << std::endl << "ERROR!!! Invalid option " << option << ".";
+      printUsage();
+    }
+  }
+
+  return toReturn;
+}
+
+// Class Verifier: It keeps the distances of a database indexed by rank (the
+// packed distances of a compact database, or an array filled from the
+// records of a binary database) and checks them with many threads.
+class Verifier {
+
+private:
+
+  // Permutation size and type
+  int n;
+  bool sign;
+
+  // Flag: only representatives of symmetry classes
+  bool symmetry;
+
+  // Number of threads
+  int threads;
+
+  // List of inversions
+  inversion_list list;
+
+  // Number of permutations
+  __uint64_t states;
+
+  // Distances: packed (compact databases) or one byte per rank
+  const __uint8_t* packed;
+  int bits;
+  std::vector<__uint8_t> table;
+
+  // Records of a binary database
+  const __uint8_t* records;
+  __uint64_t nRecords;
+  int wordBits;
+  const DatabaseHeader* header;
+
+  // Next chunk to be processed
+  std::atomic<__uint64_t> nextChunk;
+
+  // Inconsistencies found, their number and the checksum
+  std::mutex mutex;
+  std::vector<Inconsistency> found;
+  __uint64_t nFound;
+  __uint64_t checksum;
+  __uint64_t nChecked;
+  size_t maxFound;
+
+  // Returns the distance of the given rank (MISSING if there is no record)
+  int distance(const __uint64_t rank) const {
+    if (packed) return compactDistance(packed, bits, rank);
+    return __atomic_load_n(&table[rank], __ATOMIC_RELAXED);
+  }
+
+  // Returns the word of the given index of the records
+  __uint64_t word(const __uint64_t index) const {
+    switch (wordBits) {
+    case 16: return reinterpret_cast<const __uint16_t*>(records)[index];
+    case 32: return reinterpret_cast<const __uint32_t*>(records)[index];
+    default: return reinterpret_cast<const __uint64_t*>(records)[index];
+    }
+  }
+
+  // Keeps the inconsistencies found by a thread
+  void report(std::vector<Inconsistency> &local, const __uint64_t count,
+	      const __uint64_t sum, const __uint64_t checked) {
+    std::lock_guard<std::mutex> lock(mutex);
+    nFound += count;
+    checksum += sum;
+    nChecked += checked;
+    found.insert(found.end(), local.begin(), local.end());
+    std::sort(found.begin(), found.end());
+    if (found.size() > maxFound) found.resize(maxFound);
+    local.clear();
+  }
+
+  // Fills the distances of chunks of records
+  void fill() {
+    std::vector<Inconsistency> local;
+    __uint64_t count = 0;
+    while (true) {
+      __uint64_t begin = nextChunk.fetch_add(VERIFY_CHUNK);
+      if (begin >= nRecords) break;
+      __uint64_t end = std::min(begin + VERIFY_CHUNK, nRecords);
+      int layer = 0;
+      for (__uint64_t r = begin; r < end; ++r) {
+	__uint64_t intPi = word(2 * r);
+	int d = word(2 * r + 1);
+	// Layer of the record, given by the header
+	if (header) {
+	  __uint64_t offset = sizeof(DatabaseHeader) + r * wordBits / 4;
+	  while (layer < (int)header->layers && header->offsets[layer + 1] <= offset) ++layer;
+	}
+	__uint64_t rank = permutationRank(n, sign, intPi);
+	__uint8_t missing = MISSING;
+	bool valid = rank < states && permutationUnrank(n, sign, rank) == intPi;
+	if (valid && symmetry && permutationCanonical(n, sign, intPi) != intPi) {
+	  // Symmetry databases keep only the representatives of the classes
+	  Inconsistency inconsistency = { rank, d, NOT_CANONICAL };
+	  if (local.size() < maxFound) local.push_back(inconsistency);
+	  ++count;
+	} else if (!valid || d >= MISSING || (header && d != layer) ||
+		   !__atomic_compare_exchange_n(&table[rank], &missing, (__uint8_t)d, false,
+						__ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+	  // Invalid permutation or distance, record out of its layer or repeated record
+	  Inconsistency inconsistency = { rank < states ? rank : states, d, -1 };
+	  if (local.size() < maxFound) local.push_back(inconsistency);
+	  ++count;
+	}
+      }
+    }
+    report(local, count, 0, 0);
+  }
+
+  // Verifies chunks of ranks
+  void verify() {
+    std::vector<Inconsistency> local;
+    __uint64_t count = 0, sum = 0, checked = 0;
+    while (true) {
+      __uint64_t begin = nextChunk.fetch_add(VERIFY_CHUNK);
+      if (begin >= states) break;
+      __uint64_t end = std::min(begin + VERIFY_CHUNK, states);
+      for (__uint64_t rank = begin; rank < end; ++rank) {
+	__uint64_t intPi = permutationUnrank(n, sign, rank);
+	// The records of the other members of the classes were reported by fill
+	if (symmetry && permutationCanonical(n, sign, intPi) != intPi) continue;
+	int d = distance(rank);
+	int expected = 0;
+	if (rank > 0) {
+	  // The identity has rank 0
+	  expected = MISSING;
+	  for (inversion_list_it it = list.begin(); it != list.end(); ++it) {
+	    __uint64_t intSigma = permutationInversion(n, sign, intPi, (*it).i, (*it).j);
+	    if (symmetry) intSigma = permutationCanonical(n, sign, intSigma);
+	    int other = distance(permutationRank(n, sign, intSigma));
+	    if (other != MISSING) expected = std::min(expected, other + (*it).w);
+	  }
+	}
+	if (d != expected) {
+	  Inconsistency inconsistency = { rank, d, expected };
+	  if (local.size() < maxFound) local.push_back(inconsistency);
+	  ++count;
+	}
+	if (symmetry) {
+	  // The record stands for every member of its class: the checksum and
+	  // the count are the ones of a database with all permutations
+	  __uint64_t members[CLASS_SIZE];
+	  int size = permutationClass(n, sign, intPi, members);
+	  for (int m = 0; m < size; ++m)
+	    sum += KeyHash::mix((permutationRank(n, sign, members[m]) << 8) | d);
+	  checked += size;
+	} else {
+	  sum += KeyHash::mix((rank << 8) | d);
+	  ++checked;
+	}
+      }
+    }
+    report(local, count, sum, checked);
+  }
+
+  // Runs the given job with all threads
+  void parallel(void (Verifier::*job)()) {
+    nextChunk = 0;
+    std::vector<std::thread> workers;
+    for (int t = 1; t < threads; ++t)
+      workers.push_back(std::thread(job, this));
+    (this->*job)();
+    for (size_t t = 0; t < workers.size(); ++t)
+      workers[t].join();
+  }
+
+public:
+
+  // Constructor
+  Verifier(const int N, const bool S, const int T, const size_t E) {
+    n = N;
+    sign = S;
+    symmetry = false;
+    threads = T;
+    list = getPossibleInversions(SWI_LS, n, sign);
+    states = permutationCount(n, sign);
+    packed = NULL;
+    bits = 0;
+    records = NULL;
+    nRecords = 0;
+    wordBits = 0;
+    header = NULL;
+    nFound = 0;
+    checksum = 0;
+    nChecked = 0;
+    maxFound = E;
+  }
+
+  // Uses the packed distances of a compact database
+  void loadCompact(const CompactHeader &compactHeader, const __uint8_t *data) {
+    packed = data;
+    bits = compactHeader.bits;
+  }
+
+  // Fills the distances with the records of a binary database (H is its
+  // header, or NULL for databases without header)
+  void loadRecords(const __uint8_t *data, const __uint64_t count, const DatabaseHeader *H, const bool S) {
+    records = data;
+    nRecords = count;
+    wordBits = databaseWordBits(n, sign);
+    header = H;
+    symmetry = S;
+    table.assign(states, MISSING);
+    parallel(&Verifier::fill);
+  }
+
+  // Verifies all ranks and prints the result. Returns true if there are no
+  // inconsistencies.
+  bool run() {
+    parallel(&Verifier::verify);
+
+    std::cout << "Permutations : " << nChecked << std::endl;
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%016llx", (unsigned long long)checksum);
+    std::cout << "Checksum     : " << buffer << std::endl;
+    std::cout << "Errors       : " << nFound << std::endl;
+    for (size_t e = 0; e < found.size(); ++e) {
+      if (found[e].rank >= states) {
+	std::cout << "  invalid permutation" << std::endl;
+	continue;
+      }
+      __uint64_t intPi = permutationUnrank(n, sign, found[e].rank);
+      std::cout << "  ";
+      for (int i = 0; i < n; ++i)
+	std::cout << (i > 0 ? "," : "") << keyElement(n, sign, intPi, i);
+      if (found[e].distance == MISSING) {
+	std::cout << " (missing)" << std::endl;
+	continue;
+      }
+      std::cout << " " << found[e].distance;
+      if (found[e].expected == NOT_CANONICAL) std::cout << " (not the representative of its class)";
+      else if (found[e].expected < 0) std::cout << " (invalid or repeated record)";
+      else if (found[e].expected == MISSING) std::cout << " (expected: unreachable)";
+      else std::cout << " (expected: " << found[e].expected << ")";
+      std::cout << std::endl;
+    }
+    return nFound == 0;
+  }
+
+};
+
+// Does the real job.
+bool process(const Parameters parameters) {
+
+  MappedFile file(parameters.file);
+  Verifier verifier(parameters.n, parameters.sign, parameters.threads, parameters.errors);
+
+  if (isCompactFile(parameters.file)) {
+    const CompactHeader *compactHeader = reinterpret_cast<const CompactHeader*>(file.data());
+    if (compactHeader->n != parameters.n || compactHeader->sign != parameters.sign) {
+      std::cerr << std::endl << "ERROR!!! The database " << parameters.file;
+      std::cerr << " keeps permutations of a different type or size." << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    if (file.size() < sizeof(CompactHeader) + (compactHeader->count * compactHeader->bits + 7) / 8 + 1 ||
+	compactHeader->count != permutationCount(parameters.n, parameters.sign)) {
+      std::cerr << std::endl << "ERROR!!! Invalid or truncated database " << parameters.file << "." << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    verifier.loadCompact(*compactHeader, file.data() + sizeof(CompactHeader));
+  } else {
+    DatabaseHeader header;
+    __uint64_t begin = 0;
+    bool symmetry = parameters.symmetry;
+    const DatabaseHeader *headerPointer = NULL;
+    if (readDatabaseHeader(parameters.file, header)) {
+      if (header.n != parameters.n || header.sign != parameters.sign) {
+	std::cerr << std::endl << "ERROR!!! The database " << parameters.file;
+	std::cerr << " keeps permutations of a different type or size." << std::endl << std::endl;
+	exit(EXIT_FAILURE);
+      }
+      symmetry = header.symmetry;
+      begin = sizeof(header);
+      headerPointer = &header;
+    }
+    int recordBytes = databaseWordBits(parameters.n, parameters.sign) / 4;
+    verifier.loadRecords(file.data() + begin, (file.size() - begin) / recordBytes, headerPointer, symmetry);
+  }
+
+  return verifier.run();
+}
+
+// Main program
+int main (int argc, char* argv[]) {
+  return process(processArguments(argc, argv)) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
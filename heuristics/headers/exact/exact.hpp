@@ -0,0 +1,149 @@
+/******************************************************************************/
+/*                                                                            */
+/*   This file is part of SWI-LS.                                             */
+/*                                                                            */
+/*   SWI-LS is free software: you can redistribute it and/or modify           */
+/*   it under the terms of the GNU General Public License as published by     */
+/*   the Free Software Foundation, either version 2 of the License, or        */
+/*   any later version.                                                       */
+/*                                                                            */
+/*   SWI-LS is distributed in the hope that it will be useful,                */
+/*   but WITHOUT ANY WARRANTY; without even the implied warranty of           */
+/*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            */
+/*   GNU General Public License for more details.                             */
+/*                                                                            */
+/*   You should have received a copy of the GNU General Public License        */
+/*   along with SWI-LS.  If not, see <http://www.gnu.org/licenses/>.          */
+/*                                                                            */
+/******************************************************************************/
+
+/* ************************************************************************** */
+/* Exact (optimal) sorting of single permutations                             */
+/* ************************************************************************** */
+
+#ifndef __EXACT__
+#define __EXACT__
+
+#include <vector>
+#include <atomic>
+#include <cinttypes>
+
+#include <problems/problems.hpp>
+#include <permutation/permutation.hpp>
+
+#include <search/hash_table.hpp>
+#include <search/bucket_queue.hpp>
+
+// Permutations of each layer expanded at once by each thread
+#define EXACT_CHUNK 1024
+
+// Initial number of slots of the hash tables
+#define EXACT_SLOTS (1 << 16)
+
+// Parent of the permutations where the searches start
+#define EXACT_ROOT 0xFFFF
+
+// Class ExactSolver: Finds an optimal sequence of inversions which sorts a
+// permutation (of up to S_N_MAX signed or U_N_MAX unsigned elements), with a
+// bidirectional (meet-in-the-middle) Dijkstra search from the permutation and
+// from the identity. The best sequence of the heuristics is the initial upper
+// bound and, since an inversion removes at most two breakpoints, half of the
+// breakpoints of a permutation (relative to the start of the other side) is a
+// lower bound of the rest of the sequence: the permutations which can not lead
+// to a better sequence are never stored. Each side keeps its permutations in a
+// hash table, with their distances and the inversions which reached them
+// (parents), and the layers are expanded in parallel. The search stops if the
+// hash tables and the queues would need more memory than the given budget.
+class ExactSolver {
+
+public:
+
+  // Constructor
+  ExactSolver(const Problem &problem, const integer n, const bool sign,
+	      const int threads, const __uint64_t memoryBudget);
+
+  // Returns an optimal sequence of inversions which sorts pi and its weight
+  Inversions solve(const Permutation &pi, integer &weight);
+
+  // Returns the weight of the best sequence found by the heuristics (upper
+  // bound of the last call to solve)
+  integer upperBound() const { return heuristicWeight; }
+
+  // Returns the number of permutations stored by the last call to solve
+  __uint64_t explored() const { return stored; }
+
+private:
+
+  // Distance and parent (index of the inversion) of a permutation: the
+  // distance is kept in the high bits, so labels are compared by distance
+  typedef __uint32_t label;
+
+  // Permutations reached by one side of the search
+  typedef FlatHashTable<permutation_int, label> Table;
+
+  // One side of the search
+  struct Side {
+    Table table;
+    BucketQueue<permutation_int> queue;
+    // Distance of the last layer expanded
+    int settled;
+    // Signed position (negative if the element is reversed) of each element
+    // in the start of the other side, indexed by element + n + 1
+    std::vector<int> rank;
+    Side(const int maxWeight) : table(EXACT_SLOTS), queue(maxWeight), settled(-1) {}
+  };
+
+  // Permutations reached by a thread (by weight of the inversion) and the
+  // best sequence found by it (weight and permutation where the sides meet)
+  struct Worker {
+    std::vector<std::vector<permutation_int> > found;
+    int best;
+    permutation_int meeting;
+  };
+
+  // Permutation size and type
+  integer n;
+  bool sign;
+
+  // Problem (inversions and weights)
+  Problem problem;
+  Inversions inversions;
+  integer maxWeight;
+
+  // Number of threads and memory budget (bytes)
+  int threads;
+  __uint64_t memoryBudget;
+
+  // Statistics of the last call to solve
+  integer heuristicWeight;
+  __uint64_t stored;
+
+  // Layer being expanded and the next chunk of it
+  std::vector<permutation_int> layer;
+  int currentDistance;
+  int bound;
+  std::atomic<__uint64_t> nextChunk;
+
+  // Fills the ranks of the given side: the other side starts with target
+  void setTarget(Side &side, const permutation_vector &target) const;
+
+  // Returns a lower bound of the weight of the sequences which lead from the
+  // given permutation to the start of the other side
+  int lowerBound(const Side &side, const permutation_int key) const;
+
+  // Expands the chunks of the layer in the interval [begin, end), from the
+  // given side
+  void expandBatch(Side *side, const Side *other, const __uint64_t begin,
+		   const __uint64_t end, Worker *worker);
+
+  // Expands the next layer of the given side
+  void expandLayer(Side &side, const Side &other, Side &forward, Side &backward,
+		   std::vector<Worker> &workers, permutation_int &meeting);
+
+  // Appends the inversions which lead from the given permutation to the
+  // start of the given side
+  void path(const Side &side, permutation_int key, Inversions &sequence) const;
+
+};
+
+#endif // __EXACT__
@@ -43,8 +43,17 @@ public:
   static integer sort(const permutation_int intPi, const integer n, const bool sign,
 		      const Problem &problem, const integer heuristic);
 
+  static integer sort(const permutation_wide intPi, const integer n, const bool sign,
+		      const Problem &problem, const integer heuristic);
+
   static Inversions sort(const Permutation permutation, const Problem &problem,
 			 const integer heuristic, integer &weight);
+
+  // Sorts pi in place and returns the total weight of the inversions used
+  // (-1 if the heuristic fails). The steps do not allocate memory, so the
+  // same permutation may be assigned and sorted many times.
+  static integer sortWeight(Permutation &pi, const Problem &problem, const integer heuristic);
+
 };
 
 #endif // __HEURISTICS__
@@ -28,6 +28,8 @@
 #include <iostream>
 #include <cinttypes>
 
+#include <linear/keys.hpp>
+
 ////////////////////////////////////////////////////////////////////////////////
 // For unsigned permutations
 // Maximum size of an unsigned permutation
@@ -59,6 +61,11 @@
 typedef __int16_t integer;
 // Type used to represent a permutation using only 64 bits.
 typedef __uint64_t permutation_int;
+// Type used to represent a permutation using 128 bits (wider fields, up to
+// S_N_MAX_WIDE signed or U_N_MAX_WIDE unsigned elements, see linear/keys.hpp)
+typedef wide_key permutation_wide;
+#define S_N_MAX_WIDE 21
+#define U_N_MAX_WIDE 25
 // Type used to represent a permutation using a vector of integer numbers
 typedef std::vector<integer> permutation_vector;
 ////////////////////////////////////////////////////////////////////////////////
@@ -98,6 +105,57 @@ private:
   // Flag: signed/unsigned permutation
   bool sign;
 
+  // Invariants kept by applyInversion: the number of fixed points (elements
+  // at their final positions), the numbers of breakpoints (with and without
+  // sign information), a bit mask of the positions whose elements are not
+  // fixed points and the leftmost and rightmost of these positions
+  integer fixedPoints;
+  integer breakpoints;
+  integer unsignedBreakpoints;
+  std::vector<__uint64_t> misplaced;
+  integer leftmost;
+  integer rightmost;
+
+  // Bit masks of the adjacencies (k, k + 1), 0 <= k <= n, which are
+  // breakpoints (see numberOfBreakpoints) and of those which are strip
+  // boundaries (the second element is not the successor of the first one)
+  std::vector<__uint64_t> breakpointMask;
+  std::vector<__uint64_t> boundaryMask;
+
+  // Per-slice counters: the entry s * ((n + 1) / 2 + 1) + f keeps the number
+  // of positions of slice up to s whose elements have final slice up to f.
+  // They are rebuilt by the first query after the permutation changes.
+  mutable std::vector<__int32_t> sliceCounts;
+  mutable bool sliceCountsValid;
+
+  // Final slices of the elements at each position
+  mutable permutation_vector finalSlices;
+
+  // Auxiliary Fenwick trees indexed by final slice
+  mutable std::vector<__int32_t> sliceTree;
+  mutable std::vector<__int32_t> sliceTreeAfter;
+
+  // Fills the permutation with the given one (integer format)
+  template <typename Key>
+  void fromKey(const Key key, const integer N, const bool S);
+
+  // Computes the invariants of the permutation
+  void initializeInvariants();
+
+  // Updates the fixed points of the interval [i, j] (the number and the mask)
+  // by the given amount (-1 to remove them, +1 to add them)
+  void updateFixedPoints(const integer i, const integer j, const integer amount);
+
+  // Updates the masks of the adjacencies (k, k + 1), i <= k <= j
+  void updateAdjacencies(const integer i, const integer j);
+
+  // Rebuilds the per-slice counters
+  void buildSliceCounts() const;
+
+  // Returns the number of elements that form a slice misplaced pair with an
+  // element of final slice f kept at a position of slice s
+  __int32_t sliceMisplacedPartners(const integer s, const integer f) const;
+
 public:
 
   // Empty Constructor
@@ -109,6 +167,9 @@ public:
   // Constructor
   Permutation(const permutation_int intPi, const integer n, const bool sign);
 
+  // Constructor
+  Permutation(const permutation_wide intPi, const integer n, const bool sign);
+
   // Constructor
   Permutation(const permutation_vector vector, const bool sign);
 
@@ -119,7 +180,18 @@ public:
   integer element_at(const integer pos) const;
 
   // Returns true if this permutation is the identity permutation
-  bool isIdentity() const;
+  bool isIdentity() const { return fixedPoints == n; }
+
+  // Returns the number of elements at their final positions
+  integer numberOfFixedPoints() const { return fixedPoints; }
+
+  // Returns the leftmost position whose element is not at its final
+  // position (n + 1 for the identity permutation)
+  integer leftmostMisplaced() const { return leftmost; }
+
+  // Returns the rightmost position whose element is not at its final
+  // position (0 for the identity permutation)
+  integer rightmostMisplaced() const { return rightmost; }
 
   // Returns true if this permutation is a signed permutation
   bool isSigned() const { return sign; }
@@ -128,15 +200,44 @@ public:
   integer size() const { return n; }
 
   // Returns the number of breakpoints of the permutation
-  integer numberOfBreakpoints() const;
+  integer numberOfBreakpoints() const { return breakpoints; }
 
   // Returns the number of breakpoints of the permutation 
   // ignoring sign information
-  integer numberOfBreakpointsUnsignedPermutation() const;
+  integer numberOfBreakpointsUnsignedPermutation() const { return unsignedBreakpoints; }
+
+  // Returns true if the adjacency (k, k + 1) is a breakpoint, 0 <= k <= n
+  bool isBreakpoint(const integer k) const {
+    return (breakpointMask[k >> 6] >> (k & 63)) & 1;
+  }
+
+  // Returns the first adjacency (k, k + 1), from k = pos, which is a
+  // breakpoint (n + 1 if there is none)
+  integer nextBreakpoint(const integer pos) const;
+
+  // Returns the first adjacency (k, k + 1), from k = pos, which is a strip
+  // boundary (n + 1 if there is none)
+  integer nextStripBoundary(const integer pos) const;
+
+  // Returns the variation of the number of breakpoints caused by the
+  // inversion (i, j), without applying it. Only the adjacencies at the
+  // extremities of the inversion may change, so it runs in constant time.
+  integer breakpointDelta(const integer i, const integer j) const;
+
+  // Returns the variation of the number of breakpoints ignoring sign
+  // information (see numberOfBreakpointsUnsignedPermutation) caused by the
+  // inversion (i, j), without applying it
+  integer breakpointDeltaUnsignedPermutation(const integer i, const integer j) const;
 
   // Returns the number of breakpoints of the permutation
   integer sliceMisplacedPairs() const;
 
+  // Returns the variation of the number of slice misplaced pairs caused by
+  // the inversion (i, j), without applying it. The elements of the inversion
+  // which change their slices are checked against the per-slice counters;
+  // the ones which keep their slices are skipped.
+  integer sliceMisplacedPairsDelta(const integer i, const integer j) const;
+
   // Returns the final slice of the given element
   integer finalElementSlice(integer element) const {
     return slice(abs(element), n);
@@ -65,6 +65,13 @@ typedef std::vector<Inversion> Inversions;
 // Type (iterator for the list of inversions)
 typedef std::vector<Inversion>::iterator InversionsIt;
 
+// Type (constant iterator for the list of inversions)
+typedef std::vector<Inversion>::const_iterator InversionsConstIt;
+
+// Maximum number of inversions to correct a position
+// (see Problem::inversionsToCorrectPosition)
+#define CORRECTION_LENGTH 2
+
 
 class Problem {
 
@@ -95,13 +102,15 @@ public:
   integer getId() const { return id; }
 
   // Returns the list of possible inversions (accordingly to the problem)
-  Inversions getInversions() const { return inversions; }
+  const Inversions& getInversions() const { return inversions; }
 
   // Returns the weight of a given inversion (accordingly to the problem)
   integer getInversionWeight(integer i, integer j) const;
 
-  // Returns the sequence of inversions to correct the given position
-  Inversions inversionsToCorrectPosition(const integer pos, Permutation const & pi, integer &totalCost) const;
+  // Writes the sequence of inversions to correct the given position into the
+  // given array (of CORRECTION_LENGTH inversions) and returns its length
+  integer inversionsToCorrectPosition(const integer pos, Permutation const & pi,
+				      Inversion *sequence, integer &totalCost) const;
 
 };
 
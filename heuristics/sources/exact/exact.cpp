@@ -0,0 +1,265 @@
+/******************************************************************************/
+/*                                                                            */
+/*   This file is part of SWI-LS.                                             */
+/*                                                                            */
+/*   SWI-LS is free software: you can redistribute it and/or modify           */
+/*   it under the terms of the GNU General Public License as published by     */
+/*   the Free Software Foundation, either version 2 of the License, or        */
+/*   any later version.                                                       */
+/*                                                                            */
+/*   SWI-LS is distributed in the hope that it will be useful,                */
+/*   but WITHOUT ANY WARRANTY; without even the implied warranty of           */
+/*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            */
+/*   GNU General Public License for more details.                             */
+/*                                                                            */
+/*   You should have received a copy of the GNU General Public License        */
+/*   along with SWI-LS.  If not, see <http://www.gnu.org/licenses/>.          */
+/*                                                                            */
+/******************************************************************************/
+
+/* ************************************************************************** */
+/* Exact (optimal) sorting of single permutations                             */
+/* ************************************************************************** */
+
+#include <thread>
+#include <climits>
+#include <iostream>
+#include <algorithm>
+
+#include <exact/exact.hpp>
+#include <heuristics/heuristics.hpp>
+
+#define NHEURISTICS 7
+
+// Returns the label of a permutation
+static inline __uint32_t makeLabel(const int distance, const int parent) {
+  return ((__uint32_t)distance << 16) | parent;
+}
+
+// Returns the distance of a label
+static inline int labelDistance(const __uint32_t label) {
+  return label >> 16;
+}
+
+// Returns the parent of a label
+static inline int labelParent(const __uint32_t label) {
+  return label & 0xFFFF;
+}
+
+ExactSolver::ExactSolver(const Problem &P, const integer N, const bool S,
+			 const int T, const __uint64_t M) : problem(P) {
+  n = N;
+  sign = S;
+  inversions = problem.getInversions();
+  maxWeight = 0;
+  for (InversionsIt it = inversions.begin(); it != inversions.end(); ++it)
+    maxWeight = std::max(maxWeight, (*it).w);
+  threads = std::max(T, 1);
+  memoryBudget = M;
+  heuristicWeight = -1;
+  stored = 0;
+  currentDistance = 0;
+  bound = INT_MAX;
+
+  if (n > keyMaxSize<permutation_int>(sign)) {
+    std::cerr << std::endl << "ERROR!!! The exact search supports permutations of up to ";
+    std::cerr << keyMaxSize<permutation_int>(sign) << " elements." << std::endl << std::endl;
+    exit(EXIT_FAILURE);
+  }
+}
+
+void ExactSolver::setTarget(Side &side, const permutation_vector &target) const {
+  side.rank.assign(2 * n + 3, 0);
+  side.rank[n + 1 + n + 1] = n + 1;
+  for (integer i = 0; i < n; ++i) {
+    side.rank[n + 1 + target[i]] = i + 1;
+    side.rank[n + 1 - target[i]] = -(i + 1);
+  }
+}
+
+int ExactSolver::lowerBound(const Side &side, const permutation_int key) const {
+  // A pair of consecutive elements is an adjacency if it appears in the
+  // target, in the same order (or reversed, for unsigned permutations)
+  int breakpoints = 0;
+  int last = side.rank[n + 1];
+  for (integer i = 0; i <= n; ++i) {
+    int current = side.rank[n + 1 + (i < n ? keyElement(n, sign, key, i) : n + 1)];
+    int delta = current - last;
+    if (delta != 1 && (sign || delta != -1)) ++breakpoints;
+    last = current;
+  }
+  return (breakpoints + 1) / 2;
+}
+
+void ExactSolver::expandBatch(Side *side, const Side *other, const __uint64_t begin,
+			      const __uint64_t end, Worker *worker) {
+  integer nInversions = inversions.size();
+  while (true) {
+    __uint64_t first = begin + nextChunk.fetch_add(EXACT_CHUNK);
+    if (first >= end) break;
+    __uint64_t last = std::min(first + EXACT_CHUNK, end);
+    for (__uint64_t index = first; index < last; ++index) {
+      permutation_int key = layer[index];
+      for (integer k = 0; k < nInversions; ++k) {
+	const Inversion &inversion = inversions[k];
+	int newDistance = currentDistance + inversion.w;
+	permutation_int sigma = keyInversion(n, sign, key, inversion.i - 1, inversion.j - 1);
+	__uint32_t label = other->table.find(sigma);
+	if (label != Table::MISSING) {
+	  // The sides meet
+	  if (newDistance + labelDistance(label) < worker->best) {
+	    worker->best = newDistance + labelDistance(label);
+	    worker->meeting = sigma;
+	  }
+	} else if (newDistance + std::max(1, lowerBound(*side, sigma)) >= bound) {
+	  // Any sequence through sigma is not better than the upper bound
+	  continue;
+	}
+	if (side->table.insert(sigma, makeLabel(newDistance, k)))
+	  worker->found[inversion.w].push_back(sigma);
+      }
+    }
+  }
+}
+
+void ExactSolver::expandLayer(Side &side, const Side &other, Side &forward, Side &backward,
+			      std::vector<Worker> &workers, permutation_int &meeting) {
+
+  currentDistance = side.queue.pop(layer);
+
+  // Remove stale and repeated entries
+  size_t size = 0;
+  for (size_t index = 0; index < layer.size(); ++index)
+    if (labelDistance(side.table.find(layer[index])) == currentDistance)
+      layer[size++] = layer[index];
+  layer.resize(size);
+  std::sort(layer.begin(), layer.end());
+  layer.erase(std::unique(layer.begin(), layer.end()), layer.end());
+
+  // Expand the layer in batches which fit in the table
+  __uint64_t begin = 0;
+  while (begin < layer.size()) {
+    __uint64_t room = side.table.slots() / 2 > side.table.size() ? side.table.slots() / 2 - side.table.size() : 0;
+    __uint64_t batch = std::min((__uint64_t)layer.size() - begin, room / inversions.size());
+    if (batch < EXACT_CHUNK && batch < layer.size() - begin) {
+      // The old and the new slots are kept at the same time
+      __uint64_t memory = forward.table.bytes() + backward.table.bytes() + 2 * side.table.bytes();
+      memory += (forward.queue.size() + backward.queue.size() + layer.size()) * sizeof(permutation_int);
+      if (memory > memoryBudget) {
+	std::cerr << std::endl << "ERROR!!! The memory budget was exceeded (best weight found: ";
+	std::cerr << bound << ")." << std::endl << std::endl;
+	exit(EXIT_FAILURE);
+      }
+      side.table.grow();
+      continue;
+    }
+    for (int t = 0; t < threads; ++t)
+      workers[t].found.assign(maxWeight + 1, std::vector<permutation_int>());
+    nextChunk = 0;
+    if (threads == 1) {
+      expandBatch(&side, &other, begin, begin + batch, &workers[0]);
+    } else {
+      std::vector<std::thread> pool;
+      for (int t = 0; t < threads; ++t)
+	pool.push_back(std::thread(&ExactSolver::expandBatch, this, &side, &other, begin, begin + batch, &workers[t]));
+      for (int t = 0; t < threads; ++t)
+	pool[t].join();
+    }
+    for (int t = 0; t < threads; ++t) {
+      for (int w = 1; w <= maxWeight; ++w)
+	for (size_t index = 0; index < workers[t].found[w].size(); ++index)
+	  side.queue.push(currentDistance + w, workers[t].found[w][index]);
+      if (workers[t].best < bound) {
+	bound = workers[t].best;
+	meeting = workers[t].meeting;
+      }
+    }
+    begin += batch;
+  }
+
+  side.settled = currentDistance;
+}
+
+void ExactSolver::path(const Side &side, permutation_int key, Inversions &sequence) const {
+  while (true) {
+    int parent = labelParent(side.table.find(key));
+    if (parent == EXACT_ROOT) break;
+    const Inversion &inversion = inversions[parent];
+    sequence.push_back(inversion);
+    key = keyInversion(n, sign, key, inversion.i - 1, inversion.j - 1);
+  }
+}
+
+Inversions ExactSolver::solve(const Permutation &pi, integer &weight) {
+
+  // Upper bound: best sequence of the heuristics
+  Inversions best;
+  heuristicWeight = -1;
+  for (integer h = 1; h <= NHEURISTICS; ++h) {
+    integer hWeight = 0;
+    Inversions sequence = Heuristics::sort(pi, problem, h, hWeight);
+    if (hWeight >= 0 && (heuristicWeight < 0 || hWeight < heuristicWeight)) {
+      heuristicWeight = hWeight;
+      best = sequence;
+    }
+  }
+  bound = heuristicWeight >= 0 ? heuristicWeight : INT_MAX;
+  weight = heuristicWeight;
+  stored = 0;
+  if (pi.isIdentity()) {
+    weight = 0;
+    return Inversions();
+  }
+
+  // Both searches start with distance zero
+  permutation_vector vectorPi = permutation_vector(n);
+  permutation_vector vectorId = permutation_vector(n);
+  for (integer i = 0; i < n; ++i) {
+    vectorPi[i] = pi.element_at(i + 1);
+    vectorId[i] = i + 1;
+  }
+  permutation_int source = packKey<permutation_int>(n, sign, vectorPi);
+  permutation_int target = packKey<permutation_int>(n, sign, vectorId);
+
+  Side forward(maxWeight);
+  Side backward(maxWeight);
+  setTarget(forward, vectorId);
+  setTarget(backward, vectorPi);
+  forward.table.insert(source, makeLabel(0, EXACT_ROOT));
+  forward.queue.push(0, source);
+  backward.table.insert(target, makeLabel(0, EXACT_ROOT));
+  backward.queue.push(0, target);
+
+  std::vector<Worker> workers(threads);
+  for (int t = 0; t < threads; ++t)
+    workers[t].best = INT_MAX;
+
+  // Any sequence lighter than the bound passes through an inversion from a
+  // permutation settled by one side to a permutation settled by the other
+  // (found when the second one was expanded), or weights at least
+  // settled(forward) + settled(backward) + 2
+  bool found = false;
+  permutation_int meeting = 0;
+  int oldBound = bound;
+  while (bound > forward.settled + backward.settled + 2) {
+    Side &side = forward.table.size() <= backward.table.size() ? forward : backward;
+    Side &other = (&side == &forward) ? backward : forward;
+    // Every permutation which can lead to a better sequence was expanded
+    if (side.queue.empty()) break;
+    expandLayer(side, other, forward, backward, workers, meeting);
+    found = found || bound < oldBound;
+  }
+  stored = forward.table.size() + backward.table.size();
+
+  if (!found) return best;
+
+  // Sequence: from pi to the meeting permutation and from it to the identity
+  Inversions sequence;
+  path(forward, meeting, sequence);
+  std::reverse(sequence.begin(), sequence.end());
+  path(backward, meeting, sequence);
+  weight = 0;
+  for (InversionsIt it = sequence.begin(); it != sequence.end(); ++it)
+    weight += (*it).w;
+  return sequence;
+}
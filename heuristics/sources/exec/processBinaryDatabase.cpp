@@ -22,13 +22,21 @@
 /* ************************************************************************** */
 
 #include <set>
+#include <vector>
 #include <fstream>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
 #include <sys/stat.h>
 
 #include <problems/problems.hpp>
 #include <heuristics/heuristics.hpp>
 #include <permutation/permutation.hpp>
 
+#include <linear/symmetry.hpp>
+#include <format/compact.hpp>
+#include <format/database.hpp>
+
 #define READ_BUFFER_LENGTH 64000
 
 #define WRITE_BUFFER_LENGTH 64000
@@ -46,6 +54,8 @@ struct Parameters {
   integer n;
   // Output file
   std::string outfile;
+  // Flag: the database keeps only one permutation of each symmetry class
+  bool symmetry;
 };
 /* ************************************************************************** */
 
@@ -53,12 +63,16 @@ struct Parameters {
 // Prints program usage
 void printUsage() {
 
-  std::cerr << std::endl << "Usage: processBinaryDatabase <i> <n> <s> <o>" << std::endl << std::endl;
+  std::cerr << std::endl << "Usage: processBinaryDatabase <i> <n> <s> <o> [--symmetry]" << std::endl << std::endl;
 
-  std::cerr << "  <i>\tDatabase input file (binary format)." << std::endl;
+  std::cerr << "  <i>\tDatabase input file (binary or compact format, " << DATABASE_STDIO << " for a binary" << std::endl;
+  std::cerr << "     \tdatabase read from the standard input)." << std::endl;
   std::cerr << "  <n>\tPermutation size." << std::endl;
   std::cerr << "  <s>\t0 = unsigned permutations or 1 = signed permutations." << std::endl;
-  std::cerr << "  <o>\tOutput file (also in binary format)." << std::endl << std::endl;
+  std::cerr << "  <o>\tOutput file (also in binary format, " << DATABASE_STDIO << " for the standard output)." << std::endl;
+  std::cerr << "  --symmetry\tThe database keeps only one permutation of each symmetry" << std::endl;
+  std::cerr << "            \tclass: process all permutations of each class (only" << std::endl;
+  std::cerr << "            \tfor databases without header)." << std::endl << std::endl;
 
   std::cerr << " -------------------------------------------------------------------" << std::endl;
   std::cerr << " |This program processes binary database files which contains all  |" << std::endl;
@@ -92,7 +106,7 @@ void printUsage() {
 // Verifies the list of arguments
 Parameters processArguments(int argc, char* argv[]) {
 
-  if (argc != 5) printUsage();
+  if (argc != 5 && argc != 6) printUsage();
 
   bool error = false;
 
@@ -101,10 +115,11 @@ Parameters processArguments(int argc, char* argv[]) {
   toReturn.n = 0;
   toReturn.sign = true;
   toReturn.outfile = "";
+  toReturn.symmetry = false;
 
   // File
   struct stat buffer;
-  if (stat(argv[1], &buffer) != 0) {
+  if (std::string(argv[1]).compare(DATABASE_STDIO) != 0 && stat(argv[1], &buffer) != 0) {
     std::cerr << std::endl << "ERROR!!! Could not access file ";
     std::cerr << argv[1] << std::endl;
     printUsage();
@@ -128,22 +143,31 @@ Parameters processArguments(int argc, char* argv[]) {
   // Output file
   toReturn.outfile = std::string(argv[4]);
 
+  // Symmetry classes
+  if (argc == 6) {
+    if (std::string(argv[5]).compare("--symmetry") != 0) {
+      std::cerr << std::endl << "ERROR!!! Invalid option " << argv[5] << "." << std::endl;
+      printUsage();
+    }
+    toReturn.symmetry = true;
+  }
+
   return toReturn;
 }
 /* ************************************************************************** */
 
 /* ************************************************************************** */
-void processPermutation(permutation_int intPi, Parameters parameters,
-			Problem problem, integer* buffer, __uint64_t &buffer_index) {
+void processPermutation(permutation_int intPi, const Parameters &parameters,
+			const Problem &problem, integer* buffer, __uint64_t &buffer_index) {
 
   Permutation pi = Permutation(intPi, parameters.n, parameters.sign);
+  Permutation sigma;
 
   if (debug) std::cout << pi;
 
   for (integer h = 1; h < 8; ++h) {
-    buffer[buffer_index] = Heuristics::sort(intPi, parameters.n,
-					    parameters.sign,
-					    problem, h);
+    sigma = pi;
+    buffer[buffer_index] = Heuristics::sortWeight(sigma, problem, h);
     if (debug) std::cout << "\t" << buffer[buffer_index];
     buffer_index++;
   }
@@ -151,98 +175,174 @@ void processPermutation(permutation_int intPi, Parameters parameters,
 }
 /* ************************************************************************** */
 
+/* ************************************************************************** */
+// Processes a record of the database (permutation and optimum). With the
+// symmetry flag, all permutations of its symmetry class are processed.
+void processRecord(permutation_int intPi, integer optimum, const Parameters &parameters,
+		   const Problem &problem, integer* buffer, __uint64_t &buffer_index,
+		   __uint64_t buffer_length, std::ostream &outfile) {
+
+  __uint64_t members[CLASS_SIZE];
+  int size = 1;
+  members[0] = intPi;
+  if (parameters.symmetry)
+    size = permutationClass(parameters.n, parameters.sign, intPi, members);
+
+  for (int m = 0; m < size; ++m) {
+    buffer[buffer_index++] = optimum;
+    processPermutation(members[m], parameters, problem, buffer, buffer_index);
+    if (debug) std::cout << "\t" << optimum << std::endl;
+    if (buffer_index == buffer_length) {
+      outfile.write(reinterpret_cast<const char *>(buffer), buffer_length * sizeof(integer));
+      buffer_index = 0;
+    }
+  }
+
+}
+/* ************************************************************************** */
+
+/* ************************************************************************** */
+// Processes all permutations of a compact database (in rank order)
+void processCompact(const Parameters &parameters, const Problem &problem, integer* buffer,
+		    __uint64_t &buffer_index, __uint64_t buffer_length, std::ostream &outfile) {
+
+  CompactReader reader(parameters.file);
+  if (reader.header().n != parameters.n || reader.header().sign != parameters.sign) {
+    std::cerr << std::endl << "ERROR!!! The database " << parameters.file;
+    std::cerr << " keeps permutations of a different type or size." << std::endl << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  if (parameters.symmetry) {
+    std::cerr << std::endl << "ERROR!!! Compact databases keep all permutations";
+    std::cerr << " (option --symmetry is not valid)." << std::endl << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  __uint64_t rank;
+  int distance;
+  while (reader.next(rank, distance)) {
+    processRecord(permutationUnrank(parameters.n, parameters.sign, rank), distance, parameters,
+		  problem, buffer, buffer_index, buffer_length, outfile);
+  }
+
+}
+/* ************************************************************************** */
+
 /* ************************************************************************** */
 // Do the real job
-void process(const Parameters parameters) {
+void process(const Parameters options) {
 
+  Parameters parameters = options;
   permutation_int intPi;
 
   integer nHeuristics = 7;
   __uint64_t write_buffer_index = 0;
   __uint64_t write_buffer_length = (nHeuristics + 1) * WRITE_BUFFER_LENGTH;
-  __uint64_t write_buffer_size = write_buffer_length * sizeof(integer);
   integer* write_buffer = new integer[write_buffer_length];
 
-  __uint64_t nread = 0;
-  integer bufferId = 0;
-  __uint64_t  read_buffer_size = 0;
-  __uint16_t* read_buffer_16 = NULL;
-  __uint32_t* read_buffer_32 = NULL;
-  __uint64_t* read_buffer_64 = NULL;
-
-  if ((parameters.sign && parameters.n < 4) || (!parameters.sign && parameters.n < 5)) {
-    read_buffer_16 = new __uint16_t[READ_BUFFER_LENGTH];
-    read_buffer_size = READ_BUFFER_LENGTH * sizeof(__uint16_t);
-    bufferId = 1;
-  } else if ((parameters.sign && parameters.n < 7) || (!parameters.sign && parameters.n < 9)) {
-    read_buffer_32 = new __uint32_t[READ_BUFFER_LENGTH];
-    read_buffer_size = READ_BUFFER_LENGTH * sizeof(__uint32_t);
-    bufferId = 2;
-  } else {
-    read_buffer_64 = new __uint64_t[READ_BUFFER_LENGTH];
-    read_buffer_size = READ_BUFFER_LENGTH * sizeof(__uint64_t);
-    bufferId = 3;
+  // Input: the database file or the standard input (the records are
+  // processed as they arrive, so a generator may write the next layers in
+  // the meantime)
+  bool stdio = parameters.file.compare(DATABASE_STDIO) == 0;
+  bool compact = !stdio && isCompactFile(parameters.file);
+  int descriptor = stdio ? STDIN_FILENO : -1;
+  std::vector<char> read_buffer;
+
+  // Header (databases generated before it are still accepted)
+  DatabaseHeader header;
+  bool described = false;
+  if (stdio) {
+    described = readDatabaseHeader(descriptor, header, read_buffer);
+  } else if (!compact) {
+    described = readDatabaseHeader(parameters.file, header);
   }
+  if (described) {
+    if (header.n != parameters.n || header.sign != parameters.sign) {
+      std::cerr << std::endl << "ERROR!!! The database " << parameters.file;
+      std::cerr << " keeps permutations of a different type or size." << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    if (parameters.symmetry && !header.symmetry) {
+      std::cerr << std::endl << "ERROR!!! The database " << parameters.file;
+      std::cerr << " does not keep symmetry classes." << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    parameters.symmetry = header.symmetry;
+  }
+
+  int bits = databaseWordBits(parameters.n, parameters.sign);
+  size_t record_size = bits / 4;
+  size_t read_buffer_used = read_buffer.size();
+  read_buffer.resize(READ_BUFFER_LENGTH * bits / 8);
 
   Problem problem = Problem(SWI_LS, parameters.n, parameters.sign);
 
   std::ofstream outfile;
-  outfile.open(parameters.outfile, std::ios::out | std::ios::trunc | std::ios::ate | std::ios::binary);
-
-  std::ifstream infile;
-  infile.open(parameters.file, std::ios::in | std::ios::ate | std::ios::binary);
-  infile.seekg (0, std::ios::beg);
-  while (!infile.eof()) {
-
-    switch(bufferId) {
-    case 1:
-      infile.read(reinterpret_cast<char *>(read_buffer_16), read_buffer_size);
-      nread = infile.gcount() / sizeof(__uint16_t);
-      for (__uint32_t i = 0; i < nread; i+=2) {
-	intPi = read_buffer_16[i];
-	write_buffer[write_buffer_index++] = read_buffer_16[i + 1];
-	processPermutation(intPi, parameters, problem, write_buffer, write_buffer_index);
-	if (debug) std::cout << "\t" << read_buffer_16[i + 1] << std::endl;
-      }
-      break;
-    case 2:
-      infile.read(reinterpret_cast<char *>(read_buffer_32), read_buffer_size);
-      nread = infile.gcount() / sizeof(__uint32_t);
-      for (__uint32_t i = 0; i < nread; i+=2) {
-	intPi = read_buffer_32[i];
-	write_buffer[write_buffer_index++] = read_buffer_32[i + 1];
-	processPermutation(intPi, parameters, problem, write_buffer, write_buffer_index);
-	if (debug) std::cout << "\t" << read_buffer_32[i + 1] << std::endl;
-      }
-      break;
-    case 3:
-      infile.read(reinterpret_cast<char *>(read_buffer_64), read_buffer_size);
-      nread = infile.gcount() / sizeof(__uint64_t);
-      for (__uint32_t i = 0; i < nread; i+=2) {
-	intPi = read_buffer_64[i];
-	write_buffer[write_buffer_index++] = read_buffer_64[i + 1];
-	processPermutation(intPi, parameters, problem, write_buffer, write_buffer_index);
-	if (debug) std::cout << "\t" << read_buffer_64[i + 1] << std::endl;
-      }
-      break;
+  std::ostream *output = &std::cout;
+  if (parameters.outfile.compare(DATABASE_STDIO) != 0) {
+    outfile.open(parameters.outfile, std::ios::out | std::ios::trunc | std::ios::ate | std::ios::binary);
+    output = &outfile;
+  }
+
+  if (compact) {
+    processCompact(parameters, problem, write_buffer, write_buffer_index, write_buffer_length, *output);
+  } else if (!stdio) {
+    descriptor = open(parameters.file.c_str(), O_RDONLY);
+    if (descriptor < 0 || lseek(descriptor, described ? sizeof(header) : 0, SEEK_SET) < 0) {
+      std::cerr << std::endl << "ERROR!!! Could not access file " << parameters.file << std::endl;
+      exit(EXIT_FAILURE);
+    }
+  }
+  while (descriptor >= 0) {
+
+    // Reads the available bytes and processes the complete records
+    ssize_t nread = read(descriptor, read_buffer.data() + read_buffer_used, read_buffer.size() - read_buffer_used);
+    if (nread < 0) {
+      std::cerr << std::endl << "ERROR!!! Could not read the database " << parameters.file << std::endl;
+      exit(EXIT_FAILURE);
     }
-    if (write_buffer_index == write_buffer_length) {
-      outfile.write(reinterpret_cast<const char *>(write_buffer), write_buffer_size);
-      write_buffer_index = 0;
+    read_buffer_used += nread;
+    size_t nrecords = read_buffer_used / record_size;
+    for (size_t r = 0; r < nrecords; ++r) {
+      const char *record = read_buffer.data() + r * record_size;
+      __uint16_t word16[2];
+      __uint32_t word32[2];
+      __uint64_t word64[2];
+      switch(bits) {
+      case 16:
+	memcpy(word16, record, sizeof(word16));
+	intPi = word16[0];
+	processRecord(intPi, word16[1], parameters, problem,
+		      write_buffer, write_buffer_index, write_buffer_length, *output);
+	break;
+      case 32:
+	memcpy(word32, record, sizeof(word32));
+	intPi = word32[0];
+	processRecord(intPi, word32[1], parameters, problem,
+		      write_buffer, write_buffer_index, write_buffer_length, *output);
+	break;
+      default:
+	memcpy(word64, record, sizeof(word64));
+	intPi = word64[0];
+	processRecord(intPi, word64[1], parameters, problem,
+		      write_buffer, write_buffer_index, write_buffer_length, *output);
+      }
     }
+    read_buffer_used -= nrecords * record_size;
+    memmove(read_buffer.data(), read_buffer.data() + nrecords * record_size, read_buffer_used);
+
+    if (nread == 0) break;
   }
-  infile.close();
+  if (descriptor >= 0 && !stdio) close(descriptor);
 
   if (write_buffer_index != 0) {
-    outfile.write(reinterpret_cast<const char *>(write_buffer), write_buffer_index * sizeof(integer));
+    output->write(reinterpret_cast<const char *>(write_buffer), write_buffer_index * sizeof(integer));
   }
 
-  outfile.close();
+  output->flush();
+  if (outfile.is_open()) outfile.close();
 
-  if (read_buffer_16) delete read_buffer_16;
-  if (read_buffer_32) delete read_buffer_32;
-  if (read_buffer_64) delete read_buffer_64;
-  delete write_buffer;
+  delete[] write_buffer;
 }
 /* ************************************************************************** */
 
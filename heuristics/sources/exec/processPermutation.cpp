@@ -25,6 +25,8 @@
 #include <heuristics/heuristics.hpp>
 #include <permutation/permutation.hpp>
 
+#include <format/lookup.hpp>
+
 #define NHEURISTICS 7
 
 /* ************************************************************************** */
@@ -34,6 +36,8 @@ struct Parameters {
   Permutation permutation;
   // List of heuristics to be considered
   std::vector<bool> h;
+  // Compact database with the optimal distances (optional)
+  std::string database;
 };
 /* ************************************************************************** */
 
@@ -41,7 +45,7 @@ struct Parameters {
 // Prints program usage
 void printUsage() {
 
-  std::cerr << std::endl << "Usage: processPermutation <s> <p> [h]" << std::endl << std::endl;
+  std::cerr << std::endl << "Usage: processPermutation <s> <p> [h] [--database <d>]" << std::endl << std::endl;
 
   std::cerr << "  <s>\t0 = unsigned permutations or 1 = signed permutations." << std::endl;
   std::cerr << "  <p>\tPermutation." << std::endl;
@@ -54,6 +58,9 @@ void printUsage() {
   std::cerr << "\t\t5 - NB+BESTSTRIP" << std::endl;
   std::cerr << "\t\t6 - NB+LRSTRIP" << std::endl;
   std::cerr << "\t\t7 - NB+SMP" << std::endl;
+  std::cerr << "  --database <d>\tCompact database (same size and type as the" << std::endl;
+  std::cerr << "                \tpermutation): print the optimum and the gap of" << std::endl;
+  std::cerr << "                \teach heuristic." << std::endl << std::endl;
 
   std::cerr << " ----------------------------------------------------------------------" << std::endl;
   std::cerr << " |This program processes the given permutation accordingly with the   |" << std::endl;
@@ -77,7 +84,7 @@ void printUsage() {
 // Verifies the list of arguments
 Parameters processArguments(int argc, char* argv[]) {
 
-  if (argc != 3 && argc != 4) printUsage();
+  if (argc < 3) printUsage();
 
   bool error = false;
 
@@ -121,9 +128,23 @@ Parameters processArguments(int argc, char* argv[]) {
     toReturn.h[index] = false;
   }
 
+  // Options
+  std::string list = "";
+  for (int i = 3; i < argc; ++i) {
+    std::string option = std::string(argv[i]);
+    if (option.compare("--database") == 0 && i + 1 < argc) {
+      toReturn.database = std::string(argv[++i]);
+    } else if (list.empty() && option.compare(0, 2, "--") != 0) {
+      list = option;
+    } else {
+      std::cerr << std::endl << "ERROR!!! Invalid option " << option << "." << std::endl;
+      printUsage();
+    }
+  }
+
   integer nHeuristics = 0;
-  if (argc == 4) {
-    std::string aux = std::string(argv[3]);
+  if (!list.empty()) {
+    std::string aux = list;
     size_t index = 0;
     size_t length = aux.length();
     size_t comma = aux.find_first_of(",");
@@ -158,7 +179,7 @@ Parameters processArguments(int argc, char* argv[]) {
     }
   }
 
-  if (argc != 4 || nHeuristics == 0) {
+  if (nHeuristics == 0) {
     // Include all heuristics
     for (integer index = 0; index < NHEURISTICS; ++index) {
       toReturn.h[index] = true;
@@ -177,8 +198,25 @@ void process(const Parameters parameters) {
 
   Problem problem = Problem(SWI_LS, pi.size(), pi.isSigned());
 
+  // Optimal distance (-1 if there is no database)
+  integer optimum = -1;
+  if (!parameters.database.empty()) {
+    DistanceLookup lookup(parameters.database);
+    if (lookup.size() != pi.size() || lookup.isSigned() != pi.isSigned()) {
+      std::cerr << std::endl << "ERROR!!! The database " << parameters.database;
+      std::cerr << " keeps permutations of a different type or size." << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    optimum = lookup.distance(pi);
+  }
+
   std::cout << "------------------------------------------------------" << std::endl;
 
+  if (optimum >= 0) {
+    std::cout << "OPTIMUM      : " << optimum << std::endl;
+    std::cout << "------------------------------------------------------" << std::endl;
+  }
+
   for (integer h = 1; h <= 7; ++h) {
     if (parameters.h[h - 1]) {
       switch (h) {
@@ -209,6 +247,8 @@ void process(const Parameters parameters) {
       Inversions inversions = Heuristics::sort(pi, problem, h, weight);
       if (weight < 0) {
 	std::cout << "Loop or heuristic error." << std::endl;
+      } else if (optimum >= 0) {
+	std::cout << weight << " (gap: " << (weight - optimum) << ")" << std::endl;
       } else {
 	std::cout << weight << std::endl;
       }
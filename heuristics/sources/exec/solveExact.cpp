@@ -0,0 +1,188 @@
+/******************************************************************************/
+/*                                                                            */
+/*   This file is part of SWI-LS.                                             */
+/*                                                                            */
+/*   SWI-LS is free software: you can redistribute it and/or modify           */
+/*   it under the terms of the GNU General Public License as published by     */
+/*   the Free Software Foundation, either version 2 of the License, or        */
+/*   any later version.                                                       */
+/*                                                                            */
+/*   SWI-LS is distributed in the hope that it will be useful,                */
+/*   but WITHOUT ANY WARRANTY; without even the implied warranty of           */
+/*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            */
+/*   GNU General Public License for more details.                             */
+/*                                                                            */
+/*   You should have received a copy of the GNU General Public License        */
+/*   along with SWI-LS.  If not, see <http://www.gnu.org/licenses/>.          */
+/*                                                                            */
+/******************************************************************************/
+
+/* ************************************************************************** */
+/* Piece of software which finds an optimal sorting sequence of a permutation */
+/* ************************************************************************** */
+
+#include <thread>
+
+#include <exact/exact.hpp>
+#include <problems/problems.hpp>
+#include <permutation/permutation.hpp>
+
+/* ************************************************************************** */
+// Struct to receive the command line parameters
+struct Parameters {
+  // Input permutation
+  Permutation permutation;
+  // Number of threads
+  int threads;
+  // Memory budget (bytes)
+  __uint64_t memoryBudget;
+};
+/* ************************************************************************** */
+
+/* ************************************************************************** */
+// Prints program usage
+void printUsage() {
+
+  std::cerr << std::endl << "Usage: solveExact <s> <p> [--threads <t>] [--memory-budget <m>]" << std::endl << std::endl;
+
+  std::cerr << "  <s>\t0 = unsigned permutations or 1 = signed permutations." << std::endl;
+  std::cerr << "  <p>\tPermutation (up to " << U_N_MAX << " unsigned or " << S_N_MAX << " signed elements)." << std::endl;
+  std::cerr << "  --threads <t>\tNumber of threads (default: number of cores)." << std::endl;
+  std::cerr << "  --memory-budget <m>\tMaximum memory used by the search, in MB" << std::endl;
+  std::cerr << "                     \t(default: 1024)." << std::endl << std::endl;
+
+  std::cerr << " ----------------------------------------------------------------------" << std::endl;
+  std::cerr << " |This program finds an optimal sequence of inversions which sorts    |" << std::endl;
+  std::cerr << " |the given permutation accordingly with the problem SWI-LS, with a   |" << std::endl;
+  std::cerr << " |bidirectional search from the permutation and from the identity.    |" << std::endl;
+  std::cerr << " |The best result of the heuristics is used as upper bound.           |" << std::endl;
+  std::cerr << " ----------------------------------------------------------------------" << std::endl << std::endl;
+
+  exit(EXIT_FAILURE);
+
+}
+/* ************************************************************************** */
+
+/* ************************************************************************** */
+// Verifies the list of arguments
+Parameters processArguments(int argc, char* argv[]) {
+
+  if (argc < 3) printUsage();
+
+  bool error = false;
+
+  Parameters toReturn;
+  toReturn.threads = std::max(1u, std::thread::hardware_concurrency());
+  toReturn.memoryBudget = 1024ULL * 1024 * 1024;
+
+  // Signed/Unsigned
+  bool sign = std::string(argv[1]).compare("1") == 0;
+
+  // Permutation
+  permutation_vector permutation;
+  std::string aux = std::string(argv[2]);
+  size_t index = 0;
+  size_t length = aux.length();
+  size_t comma = aux.find_first_of(",");
+  try {
+    if (comma != std::string::npos) {
+      while (index < length) {
+        integer element = std::stoi(aux.substr(index, (comma - index)));
+	permutation.push_back(element);
+        index = comma + 1;
+        comma = aux.find_first_of(",", index);
+        if (comma == std::string::npos) comma = length;
+      }
+    } else {
+      integer element = std::stoi(aux.substr(0, comma));
+      permutation.push_back(element);
+    }
+  } catch (const std::exception& ia) {
+    error = true;
+  }
+  if (error) {
+    std::cerr << std::endl << "ERROR!!! Could not parse the permutation string." << std::endl;
+    printUsage();
+  }
+  if ((integer)permutation.size() > (sign ? S_N_MAX : U_N_MAX)) {
+    std::cerr << std::endl << "ERROR!!! Invalid permutation size." << std::endl;
+    printUsage();
+  }
+
+  toReturn.permutation = Permutation(permutation, sign);
+
+  // Options
+  for (int i = 3; i < argc; ++i) {
+    std::string option = std::string(argv[i]);
+    if (option.compare("--threads") == 0 && i + 1 < argc) {
+      try {
+	toReturn.threads = std::stoi(argv[++i]);
+	error = toReturn.threads < 1;
+      } catch (const std::exception& ia) {
+	error = true;
+      }
+      if (error) {
+	std::cerr << std::endl << "ERROR!!! Invalid number of threads." << std::endl;
+	printUsage();
+      }
+    } else if (option.compare("--memory-budget") == 0 && i + 1 < argc) {
+      try {
+	long long int megabytes = std::stoll(argv[++i]);
+	error = megabytes < 1;
+	toReturn.memoryBudget = megabytes * 1024 * 1024;
+      } catch (const std::exception& ia) {
+	error = true;
+      }
+      if (error) {
+	std::cerr << std::endl << "ERROR!!! Invalid memory budget." << std::endl;
+	printUsage();
+      }
+    } else {
+      std::cerr << std::endl << "ERROR!!! Invalid option " << option << "." << std::endl;
+      printUsage();
+    }
+  }
+
+  return toReturn;
+}
+/* ************************************************************************** */
+
+/* ************************************************************************** */
+// Do the real job
+void process(const Parameters parameters) {
+
+  Permutation pi = parameters.permutation;
+
+  Problem problem = Problem(SWI_LS, pi.size(), pi.isSigned());
+
+  ExactSolver solver(problem, pi.size(), pi.isSigned(), parameters.threads, parameters.memoryBudget);
+
+  integer weight = 0;
+  Inversions inversions = solver.solve(pi, weight);
+
+  std::cout << "------------------------------------------------------" << std::endl;
+  std::cout << "HEURISTICS   : " << solver.upperBound() << std::endl;
+  std::cout << "OPTIMUM      : " << weight << std::endl;
+  std::cout << "EXPLORED     : " << solver.explored() << " permutations" << std::endl;
+  std::cout << "------------------------------------------------------" << std::endl;
+
+  int nInversions = inversions.size();
+  if (nInversions > 0) {
+    std::cout << inversions[0];
+    for (integer index = 1; index < nInversions; ++index) {
+      std::cout << std::endl << inversions[index];
+    }
+  }
+
+  std::cout << std::endl << "------------------------------------------------------" << std::endl;
+
+}
+/* ************************************************************************** */
+
+/* ************************************************************************** */
+// Main program
+int main (int argc, char* argv[]) {
+  process(processArguments(argc, argv));
+  return 0;
+}
+/* ************************************************************************** */
@@ -29,6 +29,9 @@
 #include <iostream>
 #include <sys/stat.h>
 
+#include <format/compact.hpp>
+#include <format/database.hpp>
+
 typedef __int16_t integer;
 
 #define READ_BUFFER_LENGTH 64000
@@ -57,7 +60,7 @@ void printUsage() {
 
   std::cerr << std::endl << "Usage: statistics <i> <n> <s> [h]" << std::endl << std::endl;
 
-  std::cerr << "  <i>\tInput file." << std::endl;
+  std::cerr << "  <i>\tInput file (" << DATABASE_STDIO << " for the standard input)." << std::endl;
   std::cerr << "  <n>\tPermutation size." << std::endl;
   std::cerr << "  <s>\t0 = unsigned permutations or 1 = signed permutations." << std::endl;
   std::cerr << "  <h>\tList of heuristic identifiers separated by comma." << std::endl;
@@ -74,6 +77,9 @@ void printUsage() {
   std::cerr << " -----------------------------------------------------------------------" << std::endl;
   std::cerr << " |This program processes the output file produced by the program       |" << std::endl;
   std::cerr << " |processBinaryDatabase.                                               |" << std::endl;
+  std::cerr << " |                                                                     |" << std::endl;
+  std::cerr << " |If the input file is a compact database, the program lists the      |" << std::endl;
+  std::cerr << " |number (n, s, distance, count, %) of permutations of each distance.  |" << std::endl;
   std::cerr << " -----------------------------------------------------------------------" << std::endl << std::endl;
 
   std::cerr << " -----------------------------------------------------------------------" << std::endl;
@@ -116,7 +122,7 @@ Parameters processArguments(int argc, char* argv[]) {
 
   // File
   struct stat buffer;
-  if (stat(argv[1], &buffer) != 0) {
+  if (std::string(argv[1]).compare(DATABASE_STDIO) != 0 && stat(argv[1], &buffer) != 0) {
     std::cerr << std::endl << "ERROR!!! Could not access file ";
     std::cerr << argv[1] << std::endl;
     printUsage();
@@ -191,10 +197,43 @@ Parameters processArguments(int argc, char* argv[]) {
 }
 /* ************************************************************************** */
 
+/* ************************************************************************** */
+// Lists the number of permutations of each distance of a compact database
+void processCompact(const Parameters parameters) {
+
+  CompactReader reader(parameters.file);
+  if (reader.header().n != parameters.n || reader.header().sign != parameters.sign) {
+    std::cerr << std::endl << "ERROR!!! The database " << parameters.file;
+    std::cerr << " keeps permutations of a different type or size." << std::endl << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  std::vector<__int64_t> count(reader.header().maxDistance + 1, 0);
+  __uint64_t rank;
+  int distance;
+  while (reader.next(rank, distance)) {
+    if (distance < (int)count.size()) count[distance]++;
+  }
+
+  for (size_t d = 0; d < count.size(); ++d) {
+    double percentage = (count[d] * 100.0) / reader.header().count;
+    std::cout << parameters.n << "\t" << parameters.sign << "\t" << d << "\t" << count[d] << "\t";
+    std::cout << std::fixed << std::setprecision(3) << percentage << std::endl;
+  }
+
+}
+/* ************************************************************************** */
+
 /* ************************************************************************** */
 // Do the real job
 void process(const Parameters parameters) {
 
+  bool stdio = parameters.file.compare(DATABASE_STDIO) == 0;
+  if (!stdio && isCompactFile(parameters.file)) {
+    processCompact(parameters);
+    return;
+  }
+
   __uint32_t nread = 0;
   __uint64_t read_buffer_length = (NHEURISTICS + 1) * READ_BUFFER_LENGTH;
   __uint64_t read_buffer_size   = read_buffer_length * sizeof(integer);
@@ -222,12 +261,16 @@ void process(const Parameters parameters) {
   }
 
   std::ifstream infile;
-  infile.open(parameters.file, std::ios::in | std::ios::ate | std::ios::binary);
-  infile.seekg (0, std::ios::beg);
-  while (!infile.eof()) {
+  std::istream *input = &std::cin;
+  if (!stdio) {
+    infile.open(parameters.file, std::ios::in | std::ios::ate | std::ios::binary);
+    infile.seekg (0, std::ios::beg);
+    input = &infile;
+  }
+  while (!input->eof()) {
 
-    infile.read(reinterpret_cast<char *>(read_buffer), read_buffer_size);
-    nread = infile.gcount() / sizeof(integer);
+    input->read(reinterpret_cast<char *>(read_buffer), read_buffer_size);
+    nread = input->gcount() / sizeof(integer);
 
     for (__uint32_t i = 0; i < nread; i += (NHEURISTICS + 1)) {
 
@@ -304,8 +347,8 @@ void process(const Parameters parameters) {
 
     } // for (__uint32_t i = 0; i < nread; i += nColumns) {...}
 
-  } // while (!infile.eof()) {...}
-  infile.close();
+  } // while (!input->eof()) {...}
+  if (!stdio) infile.close();
 
   if (nPermutations > 0) {
 
@@ -343,11 +386,13 @@ void process(const Parameters parameters) {
 
   } // if (nPermutations > 0) {...}
 
-  delete read_buffer;
-  delete ratio1;
-  delete sumRatio;
-  delete maxRatio;
-  delete error;
+  delete[] read_buffer;
+  delete[] best;
+  delete[] ratio1;
+  delete[] exclusive;
+  delete[] sumRatio;
+  delete[] maxRatio;
+  delete[] error;
 }
 /* ************************************************************************** */
 
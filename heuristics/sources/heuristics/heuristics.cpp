@@ -22,35 +22,30 @@
 /* ************************************************************************** */
 
 #include <vector>
+#include <algorithm>
 #include <climits>
 
 #include <heuristics/heuristics.hpp>
 
 void defineRightAndLeft(Permutation &pi, integer &right, integer &left) {
-  integer n = pi.size();
-  // Update right
-  right = 1;
-  while (right <= n) {
-    if (pi.element_at(right) != right) break;
-    ++right;
-  }
-  //Update left
-  left = n;
-  while (left > 1) {
-    if (pi.element_at(left) != left) break;
-    --left;
-  }
+  // Update right (n + 1 for the identity)
+  right = pi.leftmostMisplaced();
+  //Update left (at least 1)
+  left = std::max(pi.rightmostMisplaced(), (integer)1);
 }
 
+// Buffer of the strips (see defineStrips), kept between the steps of the
+// heuristics so it is not allocated again
+static thread_local std::vector<integer> stripsBuffer;
+
 void defineStrips(Permutation &pi, integer &right, integer &left, std::vector<integer> &strips) {
   defineRightAndLeft(pi, right, left);
+  strips.clear();
   strips.push_back(right);
-  integer index = right;
+  integer index = pi.nextStripBoundary(right);
   while (index < left) {
-    if (pi.element_at(index + 1) - pi.element_at(index) != 1) {
-      strips.push_back(index + 1);
-    }
-    ++index;
+    strips.push_back(index + 1);
+    index = pi.nextStripBoundary(index + 1);
   }
   strips.push_back(left + 1);
 }
@@ -86,23 +81,18 @@ Inversion lr(Permutation &pi, const Problem &problem) {
 
   integer n = pi.size();
 
-  // Identify the first slice that is misplaced
-  integer right = 1;
-  integer left  = n;
-  while (right < left) {
-    if (pi.element_at(right) != right ||
-	pi.element_at(left) != left) {
-      break;
-    }
-    right++;
-    left--;
-  }
+  // Identify the first slice that is misplaced (or the central one)
+  integer right = std::min(std::min(pi.leftmostMisplaced(), (integer)(n + 1 - pi.rightmostMisplaced())),
+			   (integer)((n + 2) / 2));
+  integer left  = n + 1 - right;
 
   integer costRight = 0;
   integer costLeft  = 0;
 
-  Inversions inversionsRight = problem.inversionsToCorrectPosition(right, pi, costRight);
-  Inversions inversionsLeft  = problem.inversionsToCorrectPosition(left, pi, costLeft);
+  Inversion inversionsRight[CORRECTION_LENGTH];
+  Inversion inversionsLeft[CORRECTION_LENGTH];
+  integer lengthRight = problem.inversionsToCorrectPosition(right, pi, inversionsRight, costRight);
+  integer lengthLeft  = problem.inversionsToCorrectPosition(left, pi, inversionsLeft, costLeft);
 
   if (costRight != 0 && costLeft == 0) {
     // Left is already at the right place (move right)
@@ -124,7 +114,7 @@ Inversion lr(Permutation &pi, const Problem &problem) {
     return inversionsLeft[0];
   }
 
-  if (inversionsRight.size() <= inversionsLeft.size()) {
+  if (lengthRight <= lengthLeft) {
     // Right uses less inversions. Move right
     return inversionsRight[0];
   }
@@ -139,17 +129,17 @@ Inversion lr(Permutation &pi, const Problem &problem) {
 Inversion smp(Permutation &pi, const Problem &problem) {
 
   integer n = pi.size();
-  Inversions inversions = problem.getInversions();
+  const Inversions &inversions = problem.getInversions();
 
   float best = 0;
   Inversion bestInversion;
 
-  float piScore = pi.sliceMisplacedPairs();
-  for (InversionsIt it = inversions.begin(); it != inversions.end(); ++it) {
+  integer piPairs = pi.sliceMisplacedPairs();
+  float piScore = piPairs;
+  for (InversionsConstIt it = inversions.begin(); it != inversions.end(); ++it) {
     Inversion r = *it;
-    Permutation sigma = Permutation(pi);
-    sigma.applyInversion(r.i, r.j);
-    float sigmaScore = sigma.sliceMisplacedPairs();
+    integer sigmaPairs = piPairs + pi.sliceMisplacedPairsDelta(r.i, r.j);
+    float sigmaScore = sigmaPairs;
     float benefit = (piScore - sigmaScore) / r.w;
     if (benefit > best) {
       best = benefit;
@@ -199,6 +189,20 @@ Inversion smp(Permutation &pi, const Problem &problem) {
 
 
 
+// Scores the inversion (i, j) for the heuristic NB
+// (auxiliary function for the heuristic NB)
+static inline void nbCandidate(const Permutation &pi, const Problem &problem, const integer piBreakpoints,
+			       const integer i, const integer j, float &best, Inversion &bestInversion) {
+  integer w = problem.getInversionWeight(i, j);
+  float piScore = piBreakpoints;
+  float sigmaScore = piBreakpoints + pi.breakpointDelta(i, j);
+  float benefit = (piScore - sigmaScore) / w;
+  if (benefit > best) {
+    best = benefit;
+    bestInversion = Inversion(i, j, w);
+  }
+}
+
 // Heuristic NB ////////////////////////////////////////////////////////////////
 // This heuristic must be used as basis for the heuristics nb+.... (except for,
 // heuristic NB+SMP)
@@ -208,14 +212,49 @@ Inversion nb(Permutation &pi, const Problem &problem) {
   Inversion bestInversion;
   Inversion zeroUnitary;
 
-  Inversions inversions = problem.getInversions();
-  float piScore = pi.numberOfBreakpoints();
+  integer n = pi.size();
+  integer piBreakpoints = pi.numberOfBreakpoints();
+
+  if (problem.getId() == SWI_LS) {
+
+    // Every inversion is allowed, but only those next to breakpoints may
+    // remove them: in signed permutations, an adjacency which is not a
+    // breakpoint always becomes one, so both extremities must be next to
+    // breakpoints. The candidates are visited in the order of the list of
+    // inversions, so the first best one is still chosen.
+    if (pi.isSigned()) {
+      for (integer b = pi.nextBreakpoint(0); b < n; b = pi.nextBreakpoint(b + 1))
+	for (integer e = pi.nextBreakpoint(b + 1); e <= n; e = pi.nextBreakpoint(e + 1))
+	  nbCandidate(pi, problem, piBreakpoints, b + 1, e, best, bestInversion);
+    } else {
+      for (integer i = 1; i < n; ++i) {
+	if (pi.isBreakpoint(i - 1)) {
+	  for (integer j = i + 1; j <= n; ++j)
+	    nbCandidate(pi, problem, piBreakpoints, i, j, best, bestInversion);
+	} else {
+	  for (integer j = pi.nextBreakpoint(i + 1); j <= n; j = pi.nextBreakpoint(j + 1))
+	    nbCandidate(pi, problem, piBreakpoints, i, j, best, bestInversion);
+	}
+      }
+    }
+
+    if (best > 0) return bestInversion;
 
-  for (InversionsIt it = inversions.begin(); it != inversions.end(); ++it) {
+    // First unitary inversion which keeps the breakpoints
+    if (pi.isSigned())
+      for (integer i = 1; i <= n; ++i)
+	if (pi.breakpointDelta(i, i) == 0)
+	  return Inversion(i, i, problem.getInversionWeight(i, i));
+
+    return Inversion();
+  }
+
+  const Inversions &inversions = problem.getInversions();
+  float piScore = piBreakpoints;
+
+  for (InversionsConstIt it = inversions.begin(); it != inversions.end(); ++it) {
     Inversion r = *it;
-    Permutation sigma = Permutation(pi);
-    sigma.applyInversion(r.i, r.j);
-    float sigmaScore = sigma.numberOfBreakpoints();
+    float sigmaScore = piBreakpoints + pi.breakpointDelta(r.i, r.j);
     float benefit = (piScore - sigmaScore) / r.w;
     if (benefit > best) {
       best = benefit;
@@ -275,7 +314,7 @@ Inversion nb_plus_beststrip(Permutation &pi, const Problem &problem) {
 
     integer right = 0;
     integer left = 0;
-    std::vector<integer> strips;
+    std::vector<integer> &strips = stripsBuffer;
     defineStrips(pi, right, left, strips);
 
     integer lowestWeight = SHRT_MAX;
@@ -309,7 +348,7 @@ Inversion nb_plus_lrstrip(Permutation &pi, const Problem &problem) {
 
     integer right = 0;
     integer left = 0;
-    std::vector<integer> strips;
+    std::vector<integer> &strips = stripsBuffer;
     defineStrips(pi, right, left, strips);
 
     integer pos_right = pi.position(right);
@@ -358,7 +397,9 @@ Inversion nb_plus_smp(Permutation &pi, const Problem &problem) {
   float best = 0;
   Inversion bestInversion;
 
-  Inversions inversions;
+  const Inversions &inversions = problem.getInversions();
+  integer piBreakpoints;
+  integer piPairs = pi.sliceMisplacedPairs();
   float piScore;
 
   /////////////////////////////////////////////////////////////////////////////
@@ -366,14 +407,14 @@ Inversion nb_plus_smp(Permutation &pi, const Problem &problem) {
   /////////////////////////////////////////////////////////////////////////////
 
   if (pi.isSigned()) {
-    inversions = problem.getInversions();
-    piScore = pi.numberOfBreakpoints() + ((float)pi.sliceMisplacedPairs() / n_sq);
+    piBreakpoints = pi.numberOfBreakpoints();
+    piScore = piBreakpoints + ((float)piPairs / n_sq);
 
-    for (InversionsIt it = inversions.begin(); it != inversions.end(); ++it) {
+    for (InversionsConstIt it = inversions.begin(); it != inversions.end(); ++it) {
       Inversion r = *it;
-      Permutation sigma = Permutation(pi);
-      sigma.applyInversion(r.i, r.j);
-      float sigmaScore = sigma.numberOfBreakpoints() + ((float)sigma.sliceMisplacedPairs() / n_sq);
+      integer sigmaBreakpoints = piBreakpoints + pi.breakpointDelta(r.i, r.j);
+      integer sigmaPairs = piPairs + pi.sliceMisplacedPairsDelta(r.i, r.j);
+      float sigmaScore = sigmaBreakpoints + ((float)sigmaPairs / n_sq);
       float benefit = (piScore - sigmaScore) / r.w;
       if (benefit > best) {
 	best = benefit;
@@ -389,14 +430,14 @@ Inversion nb_plus_smp(Permutation &pi, const Problem &problem) {
   /////////////////REMMAINING or UNSIGNED SECTION /////////////////////////////
   /////////////////////////////////////////////////////////////////////////////
 
-  inversions = problem.getInversions();
-  piScore = pi.numberOfBreakpointsUnsignedPermutation() + ((float)pi.sliceMisplacedPairs() / n_sq);
+  piBreakpoints = pi.numberOfBreakpointsUnsignedPermutation();
+  piScore = piBreakpoints + ((float)piPairs / n_sq);
 
-  for (InversionsIt it = inversions.begin(); it != inversions.end(); ++it) {
+  for (InversionsConstIt it = inversions.begin(); it != inversions.end(); ++it) {
     Inversion r = *it;
-    Permutation sigma = Permutation(pi);
-    sigma.applyInversion(r.i, r.j);
-    float sigmaScore = sigma.numberOfBreakpointsUnsignedPermutation() + ((float)sigma.sliceMisplacedPairs() / n_sq);
+    integer sigmaBreakpoints = piBreakpoints + pi.breakpointDeltaUnsignedPermutation(r.i, r.j);
+    integer sigmaPairs = piPairs + pi.sliceMisplacedPairsDelta(r.i, r.j);
+    float sigmaScore = sigmaBreakpoints + ((float)sigmaPairs / n_sq);
     float benefit = (piScore - sigmaScore) / r.w;
     if (benefit > best) {
       best = benefit;
@@ -416,13 +457,27 @@ Inversion nb_plus_smp(Permutation &pi, const Problem &problem) {
 integer Heuristics::sort(const permutation_int intPi, const integer n,
 			 const bool sign, const Problem &problem,
 			 const integer heuristic) {
+  Permutation pi = Permutation(intPi, n, sign);
+  return sortWeight(pi, problem, heuristic);
+}
+
+// SORT ////////////////////////////////////////////////////////////////////////
+integer Heuristics::sort(const permutation_wide intPi, const integer n,
+			 const bool sign, const Problem &problem,
+			 const integer heuristic) {
+  Permutation pi = Permutation(intPi, n, sign);
+  return sortWeight(pi, problem, heuristic);
+}
+
+// SORT ////////////////////////////////////////////////////////////////////////
+integer Heuristics::sortWeight(Permutation &pi, const Problem &problem,
+			       const integer heuristic) {
 
   Inversion inversion;
   integer weight = 0;
   integer tries  = 0;
-  integer limit  = n * LIMIT_MULTIPLIER;
+  integer limit  = pi.size() * LIMIT_MULTIPLIER;
 
-  Permutation pi = Permutation(intPi, n, sign);
   while (!pi.isIdentity()) {
     switch (heuristic) {
     case LR:
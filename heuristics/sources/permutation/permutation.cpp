@@ -21,6 +21,7 @@
 /* Class permutation                                                          */
 /* ************************************************************************** */
 
+#include <algorithm>
 #include <unordered_set>
 
 #include <permutation/permutation.hpp>
@@ -28,6 +29,12 @@
 Permutation::Permutation() {
   n = 0;
   sign = false;
+  sliceCountsValid = false;
+  fixedPoints = 0;
+  breakpoints = 0;
+  unsignedBreakpoints = 0;
+  leftmost = 1;
+  rightmost = 0;
 }
 
 Permutation::Permutation(Permutation const &other) {
@@ -36,6 +43,7 @@ Permutation::Permutation(Permutation const &other) {
 
   // Set the flag of signed/unsigned permutation
   sign = other.isSigned();
+  sliceCountsValid = false;
 
   // Create the vectors (permutation and inverse)
   permutation        = permutation_vector(n + 2);
@@ -52,16 +60,19 @@ Permutation::Permutation(Permutation const &other) {
     inverse[abs(element)] = i;
   }
 
+  initializeInvariants();
 }
 
 
-Permutation::Permutation(const permutation_int intPi, const integer N, const bool S) {
+template <typename Key>
+void Permutation::fromKey(const Key key, const integer N, const bool S) {
 
   // Set the permutation size
   n = N;
 
   // Set the flag of signed/unsigned permutation
   sign = S;
+  sliceCountsValid = false;
 
   // Create the vectors (permutation and inverse)
   permutation        = permutation_vector(n + 2);
@@ -71,39 +82,33 @@ Permutation::Permutation(const permutation_int intPi, const integer N, const boo
   inverse[0]         = 0;
   inverse[n + 1]     = n + 1;
 
-  if (sign) {
-    permutation_int aux = intPi;
-    for (integer i = n - 1; i >= 0; --i) {
-      integer last = (aux & S_NUMBERS) + 1;
-      integer sign = aux & S_SIGN;
-      if (sign) permutation[i + 1] = -last;
-      else permutation[i + 1] = last;
-      inverse[last] = i + 1;
-      aux = aux >> S_N_BITS;
-    }
-  } else {
-    permutation_int aux = intPi;
-    for (integer i = n - 1; i >= 0; --i) {
-      integer last = (aux & U_NUMBERS) + 1;
-      permutation[i + 1] = last;
-      inverse[last] = i + 1;
-      aux = aux >> U_N_BITS;
-    }
+  for (integer i = 0; i < n; ++i) {
+    integer element = keyElement(n, sign, key, i);
+    permutation[i + 1] = element;
+    inverse[abs(element)] = i + 1;
   }
 
-  // Validate the permutation
-  std::unordered_set<integer> elements = std::unordered_set<integer>();
+  // Validate the permutation (the fields of the keys are at most 32)
+  __uint64_t elements = 0;
   for (integer i = 1; i <= n; ++i) {
-    elements.insert(abs(permutation[i]));
+    elements |= 1ULL << abs(permutation[i]);
   }
 
-  for (integer i = 1; i <= n; ++i) {
-    if (elements.find(i) == elements.end()) {
-      std::cerr << std::endl << "ERROR!!! Invalid permutation!" << std::endl << std::endl;
-      exit(EXIT_FAILURE);
-    }
+  if (elements != (2ULL << n) - 2) {
+    std::cerr << std::endl << "ERROR!!! Invalid permutation!" << std::endl << std::endl;
+    exit(EXIT_FAILURE);
   }
 
+  initializeInvariants();
+
+}
+
+Permutation::Permutation(const permutation_int intPi, const integer N, const bool S) {
+  fromKey(intPi, N, S);
+}
+
+Permutation::Permutation(const permutation_wide intPi, const integer N, const bool S) {
+  fromKey(intPi, N, S);
 }
 
 Permutation::Permutation(const permutation_vector vector, const bool S) {
@@ -113,6 +118,7 @@ Permutation::Permutation(const permutation_vector vector, const bool S) {
 
   // Set the flag of signed/unsigned permutation
   sign = S;
+  sliceCountsValid = false;
 
   // Create the vectors (permutation and inverse)
   permutation        = permutation_vector(n + 2);
@@ -143,6 +149,8 @@ Permutation::Permutation(const permutation_vector vector, const bool S) {
       exit(EXIT_FAILURE);
     }
   }
+
+  initializeInvariants();
 }
 
 // Warning !!! For performance purposes, we are not checking the boundaries of the vector.
@@ -157,10 +165,39 @@ integer Permutation::element_at(const integer pos) const {
 }
 
 
+// Returns the first bit set in the mask from pos (none if there is none)
+static inline integer nextBit(const std::vector<__uint64_t> &mask, const integer pos, const integer none) {
+  integer index = pos >> 6;
+  integer words = mask.size();
+  __uint64_t word = mask[index] & (~0ULL << (pos & 63));
+  while (word == 0) {
+    if (++index == words) return none;
+    word = mask[index];
+  }
+  return (index << 6) + __builtin_ctzll(word);
+}
+
+
+// Returns the last bit set in the mask up to pos (none if there is none)
+static inline integer previousBit(const std::vector<__uint64_t> &mask, const integer pos, const integer none) {
+  integer index = pos >> 6;
+  __uint64_t word = mask[index] & (~0ULL >> (63 - (pos & 63)));
+  while (word == 0) {
+    if (--index < 0) return none;
+    word = mask[index];
+  }
+  return (index << 6) + 63 - __builtin_clzll(word);
+}
+
+
 void Permutation::applyInversion(const integer i, const integer j) {
   integer aux;
   integer b = i;
   integer e = j;
+  sliceCountsValid = false;
+  breakpoints += breakpointDelta(i, j);
+  unsignedBreakpoints += breakpointDeltaUnsignedPermutation(i, j);
+  updateFixedPoints(i, j, -1);
   if (sign) {
     while (b <= e) {
       aux = permutation[b];
@@ -182,47 +219,101 @@ void Permutation::applyInversion(const integer i, const integer j) {
       --e;
     }
   }
+  updateFixedPoints(i, j, +1);
+  updateAdjacencies(i - 1, j);
+  // Positions out of the interval keep their elements
+  if (leftmost >= i) leftmost = nextBit(misplaced, i, n + 1);
+  if (rightmost <= j) rightmost = previousBit(misplaced, j, 0);
 }
 
 
-bool Permutation::isIdentity() const {
-  for (integer i = 1; i <= n; ++i) {
-    if (permutation[i] != i) return false;
+void Permutation::updateFixedPoints(const integer i, const integer j, const integer amount) {
+  for (integer k = i; k <= j; ++k) {
+    if (permutation[k] == k) {
+      fixedPoints += amount;
+      if (amount < 0) misplaced[k >> 6] |= 1ULL << (k & 63);
+      else misplaced[k >> 6] &= ~(1ULL << (k & 63));
+    }
   }
-  return true;
 }
 
 
-integer Permutation::numberOfBreakpoints() const {
-  integer breakpoints = 0;
-  integer last = n + 1;
-  integer current = 0;
-  if (sign) {
-    for (integer i = n; i >= 0; --i) {
-      current = permutation[i];
-      if (last - current != 1) ++breakpoints;
-      last = current;
-    }
-  } else {
-    for (integer i = n; i >= 0; --i) {
-      current = permutation[i];
-      if (abs(last - current) != 1) ++breakpoints;
-      last = current;
-    }
+integer Permutation::nextBreakpoint(const integer pos) const {
+  return nextBit(breakpointMask, pos, n + 1);
+}
+
+
+integer Permutation::nextStripBoundary(const integer pos) const {
+  return nextBit(boundaryMask, pos, n + 1);
+}
+
+
+void Permutation::updateAdjacencies(const integer i, const integer j) {
+  for (integer k = i; k <= j; ++k) {
+    integer difference = permutation[k + 1] - permutation[k];
+    __uint64_t bit = 1ULL << (k & 63);
+    if (difference != 1) boundaryMask[k >> 6] |= bit;
+    else boundaryMask[k >> 6] &= ~bit;
+    if (sign ? difference != 1 : abs(difference) != 1) breakpointMask[k >> 6] |= bit;
+    else breakpointMask[k >> 6] &= ~bit;
   }
-  return breakpoints;
 }
 
-integer Permutation::numberOfBreakpointsUnsignedPermutation() const {
-  integer breakpoints = 0;
+
+// The breakpoints are counted from the right (position n + 1) to the left
+void Permutation::initializeInvariants() {
+  breakpoints = 0;
+  unsignedBreakpoints = 0;
   integer last = n + 1;
   integer current = 0;
   for (integer i = n; i >= 0; --i) {
-    current = abs(permutation[i]);
-    if (abs(last - current) != 1) ++breakpoints;
+    current = permutation[i];
+    if (sign ? last - current != 1 : abs(last - current) != 1) ++breakpoints;
+    if (abs(abs(last) - abs(current)) != 1) ++unsignedBreakpoints;
     last = current;
   }
-  return breakpoints;
+  // Initially, every position is taken as misplaced
+  fixedPoints = 0;
+  misplaced.assign((n + 2 + 63) / 64, 0);
+  for (integer i = 1; i <= n; ++i)
+    misplaced[i >> 6] |= 1ULL << (i & 63);
+  updateFixedPoints(1, n, +1);
+  leftmost = nextBit(misplaced, 1, n + 1);
+  rightmost = previousBit(misplaced, n, 0);
+  breakpointMask.assign(misplaced.size(), 0);
+  boundaryMask.assign(misplaced.size(), 0);
+  updateAdjacencies(0, n);
+}
+
+
+// Inside of the inversion, each adjacency (a, b) becomes (-b, -a) in signed
+// permutations, or (b, a) otherwise, and keeps its breakpoint. Hence, only
+// the adjacencies (i - 1, i) and (j, j + 1) have to be checked.
+integer Permutation::breakpointDelta(const integer i, const integer j) const {
+  integer before = permutation[i - 1];
+  integer first  = permutation[i];
+  integer last   = permutation[j];
+  integer after  = permutation[j + 1];
+  integer delta  = 0;
+  if (sign) {
+    delta -= (first - before != 1) + (after - last != 1);
+    delta += (-last - before != 1) + (after + first != 1);
+  } else {
+    delta -= (abs(first - before) != 1) + (abs(after - last) != 1);
+    delta += (abs(last - before) != 1) + (abs(after - first) != 1);
+  }
+  return delta;
+}
+
+integer Permutation::breakpointDeltaUnsignedPermutation(const integer i, const integer j) const {
+  integer before = abs(permutation[i - 1]);
+  integer first  = abs(permutation[i]);
+  integer last   = abs(permutation[j]);
+  integer after  = abs(permutation[j + 1]);
+  integer delta  = 0;
+  delta -= (abs(first - before) != 1) + (abs(after - last) != 1);
+  delta += (abs(last - before) != 1) + (abs(after - first) != 1);
+  return delta;
 }
 
 
@@ -269,3 +360,127 @@ integer Permutation::sliceMisplacedPairs() const {
 
   return slice_misplaced_pairs;
 }
+
+
+void Permutation::buildSliceCounts() const {
+  integer slices = (n + 1) / 2;
+  __int32_t width = slices + 1;
+  sliceCounts.assign(width * width, 0);
+  sliceTree.assign(width, 0);
+  sliceTreeAfter.assign(width, 0);
+  finalSlices.resize(n + 2);
+  for (integer i = 1; i <= n; ++i) {
+    finalSlices[i] = finalElementSlice(permutation[i]);
+    sliceCounts[slice(i, n) * width + finalSlices[i]]++;
+  }
+  for (integer s = 1; s <= slices; ++s)
+    for (integer f = 1; f <= slices; ++f)
+      sliceCounts[s * width + f] += sliceCounts[(s - 1) * width + f] + sliceCounts[s * width + f - 1]
+	- sliceCounts[(s - 1) * width + f - 1];
+  sliceCountsValid = true;
+}
+
+
+__int32_t Permutation::sliceMisplacedPartners(const integer s, const integer f) const {
+  integer slices = (n + 1) / 2;
+  __int32_t width = slices + 1;
+  const __int32_t *counts = sliceCounts.data();
+  // Lower slices with greater final slices, plus the other way around
+  return (counts[(s - 1) * width + slices] - counts[(s - 1) * width + f]) +
+    (counts[slices * width + f - 1] - counts[s * width + f - 1]);
+}
+
+
+// Adds one to the entry f of the Fenwick tree
+static inline void treeInsert(std::vector<__int32_t> &tree, integer f) {
+  for (integer size = tree.size(); f < size; f += f & -f) tree[f]++;
+}
+
+// Returns the sum of the entries up to f of the Fenwick tree
+static inline __int32_t treeCount(const std::vector<__int32_t> &tree, integer f) {
+  __int32_t count = 0;
+  for (; f > 0; f -= f & -f) count += tree[f];
+  return count;
+}
+
+// Clears the entries changed by the insertion of f into the Fenwick tree
+static inline void treeClear(std::vector<__int32_t> &tree, integer f) {
+  for (integer size = tree.size(); f < size && tree[f] != 0; f += f & -f) tree[f] = 0;
+}
+
+
+// The pairs between the moved elements (those which change their slices) and
+// the whole permutation come from the per-slice counters, before and after the
+// move of each element. The counters keep, however, the moved elements at
+// their old slices: the pairs among these elements are corrected by a sweep
+// over the slices of the inversion, which counts them with Fenwick trees. The
+// elements which keep their slices are skipped: their pairs with the moved
+// elements are already right in the counters, and their pairs among
+// themselves do not change.
+integer Permutation::sliceMisplacedPairsDelta(const integer i, const integer j) const {
+
+  // Unitary and symmetric inversions keep every element in its slice
+  if (i == j || i + j == n + 1) return 0;
+
+  if (!sliceCountsValid) buildSliceCounts();
+  const integer *finals = finalSlices.data();
+
+  __int32_t delta = 0;
+
+  // Pairs with the whole permutation, after and before the move of each
+  // element. The pairs of moved elements with the same final slice are
+  // counted for the last correction.
+  __int32_t twins = 0;
+  for (integer k = i; k <= j; ++k) {
+    integer from = slice(k, n), to = slice(i + j - k, n);
+    if (from == to) continue;
+    integer f = finals[k];
+    delta += sliceMisplacedPartners(to, f) - sliceMisplacedPartners(from, f);
+    integer twin = inverse[n + 1 - abs(permutation[k])];
+    if (twin > k && twin <= j && slice(twin, n) != slice(i + j - twin, n)) ++twins;
+  }
+
+  // Slices covered by the inversion
+  integer low  = std::min(slice(i, n), slice(j, n));
+  integer high = slice(std::max(i, std::min(j, (integer)((n + 1) / 2))), n);
+
+  // Elements moved to (or taken from) the positions of each slice: sliceTree
+  // keeps the final slices of the elements before the inversion and
+  // sliceTreeAfter, after it
+  __int32_t after = 0;
+  for (integer s = low; s <= high; ++s) {
+    integer positions[2] = { s, symmetric(s, n) };
+    integer count = (positions[0] == positions[1]) ? 1 : 2;
+    for (integer k = 0; k < count; ++k) {
+      if (positions[k] < i || positions[k] > j || slice(i + j - positions[k], n) == s) continue;
+      integer f = finals[i + j - positions[k]];
+      // Pairs among the moved elements after the inversion, and before it
+      // (the latter were removed twice), and pairs with the old slices of
+      // the moved elements (lower slices)
+      delta += after - treeCount(sliceTreeAfter, f);
+      delta += treeCount(sliceTree, f) - treeCount(sliceTree, finals[positions[k]]);
+    }
+    for (integer k = 0; k < count; ++k) {
+      if (positions[k] < i || positions[k] > j || slice(i + j - positions[k], n) == s) continue;
+      treeInsert(sliceTreeAfter, finals[i + j - positions[k]]);
+      treeInsert(sliceTree, finals[positions[k]]);
+      ++after;
+    }
+    // Pairs with the old slices of the moved elements (higher slices are the
+    // remaining ones of lower final slices)
+    for (integer k = 0; k < count; ++k) {
+      if (positions[k] < i || positions[k] > j || slice(i + j - positions[k], n) == s) continue;
+      delta += treeCount(sliceTree, finals[i + j - positions[k]] - 1);
+    }
+  }
+  delta -= after * (after - 1) / 2 - twins;
+
+  // Clear the Fenwick trees
+  for (integer k = i; k <= j; ++k) {
+    if (slice(k, n) == slice(i + j - k, n)) continue;
+    treeClear(sliceTree, finals[k]);
+    treeClear(sliceTreeAfter, finals[k]);
+  }
+
+  return delta;
+}
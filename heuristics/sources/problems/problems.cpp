@@ -73,16 +73,16 @@ integer Problem::getInversionWeight(integer i, integer j) const {
   exit(EXIT_FAILURE);
 }
 
-Inversions Problem::inversionsToCorrectPosition(const integer pos, Permutation const & pi,
-					      integer &totalCost) const {
+integer Problem::inversionsToCorrectPosition(const integer pos, Permutation const & pi,
+					     Inversion *sequence, integer &totalCost) const {
 
   // To correct a position pos, we have to bring the element e = pos) to the right position
 
   // Auxiliary variables
   integer i, j;
 
-  // Vector to keep the inversions
-  Inversions toReturn;
+  // Number of inversions of the sequence
+  integer length = 0;
 
   // Get the current position of the element e = pos
   integer current_pos = pi.position(pos);
@@ -102,7 +102,7 @@ Inversions Problem::inversionsToCorrectPosition(const integer pos, Permutation c
     if (pi.isSigned() && element < 0) {
       // However, an unitary inversion is needed.
       weight = getInversionWeight(pos, pos);
-      toReturn.push_back(Inversion(pos, pos, weight));
+      sequence[length++] = Inversion(pos, pos, weight);
       totalCost = weight;
     } // if (pi.isSigned() && element < 0) { ... }
 
@@ -117,12 +117,12 @@ Inversions Problem::inversionsToCorrectPosition(const integer pos, Permutation c
       if (current_pos < pos) { i = current_pos; j = pos; }
       else { i = pos; j = current_pos; }
       weight = getInversionWeight(i, j);
-      toReturn.push_back(Inversion(i, j, weight));
+      sequence[length++] = Inversion(i, j, weight);
       totalCost = weight;
       if (pi.isSigned() && element > 0) {
 	// An additional unitary inversion is needed.
 	weight = getInversionWeight(pos, pos);
-	toReturn.push_back(Inversion(pos, pos, weight));
+	sequence[length++] = Inversion(pos, pos, weight);
 	totalCost += weight;
       }
       break;
@@ -135,5 +135,5 @@ Inversions Problem::inversionsToCorrectPosition(const integer pos, Permutation c
 
   } // if (current_pos == pos) { ... } else { ... }
 
-  return toReturn;
+  return length;
 }